@@ -0,0 +1,314 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "header.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+// Every block handed out is aligned for any scalar type
+#define ALLOC_ALIGN 16
+#define ALIGN_UP(x) (((x) + ALLOC_ALIGN - 1) & ~(size_t)(ALLOC_ALIGN - 1))
+
+// Size classes of the pool allocator: 16 B << 0 .. 16 B << 16 (1 MiB)
+#define POOL_MIN_SHIFT 4
+#define POOL_CLASSES 17
+#define POOL_SLAB_SIZE (256 * 1024)
+
+#define HUGE_PAGE_SIZE (2 * 1024 * 1024)
+
+// ----------------- Heap (malloc/free) -----------------
+
+static void *heap_alloc(graph_allocator *a, size_t size) {
+    (void)a;
+    return calloc(1, size ? size : 1);
+}
+
+static void heap_free(graph_allocator *a, void *p, size_t size) {
+    (void)a;
+    (void)size;
+    free(p);
+}
+
+static graph_allocator default_heap = { heap_alloc, heap_free, NULL, false };
+
+// The process-wide malloc-backed allocator used when none is given
+graph_allocator *heap_allocator(void) {
+    return &default_heap;
+}
+
+// ----------------- Arena (bump pointer) -----------------
+
+typedef struct arena_chunk {
+    struct arena_chunk *prev;
+    size_t capacity;
+    size_t used;
+    bool huge;                  // mapped with the OS page allocator
+    unsigned char *base;
+} arena_chunk;
+
+typedef struct {
+    graph_allocator base;       // must stay first
+    arena_chunk *current;
+    size_t chunk_size;
+    bool huge_pages;
+} arena_allocator;
+
+// Large, ideally huge-page backed, zeroed mapping. Falls back to regular
+// pages when the OS has no huge pages reserved.
+static void *map_region(size_t size) {
+#if defined(_WIN32)
+    SIZE_T large = GetLargePageMinimum();
+    if (large > 0 && size % large == 0) {
+        void *p = VirtualAlloc(NULL, size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+        if (p != NULL) {
+            return p;
+        }
+    }
+    return VirtualAlloc(NULL, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+#else
+    void *p = MAP_FAILED;
+#ifdef MAP_HUGETLB
+    p = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+#endif
+    if (p == MAP_FAILED) {
+        p = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) {
+            return NULL;
+        }
+#ifdef MADV_HUGEPAGE
+        // Transparent huge pages, if enabled
+        madvise(p, size, MADV_HUGEPAGE);
+#endif
+    }
+    return p;
+#endif
+}
+
+static void unmap_region(void *p, size_t size) {
+#if defined(_WIN32)
+    (void)size;
+    VirtualFree(p, 0, MEM_RELEASE);
+#else
+    munmap(p, size);
+#endif
+}
+
+static arena_chunk *arena_new_chunk(arena_allocator *arena, size_t min_size) {
+    size_t capacity = arena->chunk_size;
+    if (capacity < min_size) {
+        capacity = min_size;
+    }
+    arena_chunk *chunk = malloc(sizeof(*chunk));
+    if (chunk == NULL) {
+        return NULL;
+    }
+    chunk->huge = arena->huge_pages;
+    if (chunk->huge) {
+        capacity = (capacity + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+        chunk->base = map_region(capacity);
+    } else {
+        chunk->base = malloc(capacity);
+    }
+    if (chunk->base == NULL) {
+        free(chunk);
+        return NULL;
+    }
+    chunk->capacity = capacity;
+    chunk->used = 0;
+    chunk->prev = arena->current;
+    arena->current = chunk;
+    return chunk;
+}
+
+static void *arena_alloc(graph_allocator *a, size_t size) {
+    arena_allocator *arena = (arena_allocator *)a;
+    size = ALIGN_UP(size ? size : 1);
+    arena_chunk *chunk = arena->current;
+    if (chunk == NULL || chunk->capacity - chunk->used < size) {
+        chunk = arena_new_chunk(arena, size);
+        if (chunk == NULL) {
+            return NULL;
+        }
+    }
+    void *p = chunk->base + chunk->used;
+    chunk->used += size;
+    memset(p, 0, size);
+    return p;
+}
+
+// Only the most recent allocation can be given back (stack discipline), which
+// is what scratch buffers freed in reverse order do. Anything else waits for
+// the whole arena to be released.
+static void arena_free(graph_allocator *a, void *p, size_t size) {
+    arena_allocator *arena = (arena_allocator *)a;
+    arena_chunk *chunk = arena->current;
+    size = ALIGN_UP(size ? size : 1);
+    if (p != NULL && chunk != NULL && chunk->used >= size &&
+        (unsigned char *)p == chunk->base + chunk->used - size) {
+        chunk->used -= size;
+    }
+}
+
+static void arena_destroy(graph_allocator *a) {
+    arena_allocator *arena = (arena_allocator *)a;
+    arena_chunk *chunk = arena->current;
+    while (chunk != NULL) {
+        arena_chunk *prev = chunk->prev;
+        if (chunk->huge) {
+            unmap_region(chunk->base, chunk->capacity);
+        } else {
+            free(chunk->base);
+        }
+        free(chunk);
+        chunk = prev;
+    }
+    free(arena);
+}
+
+static graph_allocator *new_arena(size_t chunk_size, bool huge_pages) {
+    arena_allocator *arena = malloc(sizeof(*arena));
+    if (arena == NULL) {
+        return NULL;
+    }
+    arena->base.alloc = arena_alloc;
+    arena->base.release = arena_free;
+    arena->base.destroy = arena_destroy;
+    arena->base.releases_in_bulk = true;
+    arena->current = NULL;
+    arena->chunk_size = chunk_size ? chunk_size : 1024 * 1024;
+    arena->huge_pages = huge_pages;
+    return &arena->base;
+}
+
+// Bump allocator: allocation is a pointer increment, and everything is
+// returned at once by destroy_allocator. Graphs built in an arena are torn
+// down in O(1) by destroy_graph.
+graph_allocator *create_arena_allocator(size_t chunk_size) {
+    return new_arena(chunk_size, false);
+}
+
+// Arena whose chunks are mapped with 2 MiB pages when the OS allows it,
+// cutting TLB misses on large adjacency matrices. 'region_size' is the
+// size of each mapping.
+graph_allocator *create_huge_page_allocator(size_t region_size) {
+    return new_arena(region_size ? region_size : 64 * (size_t)HUGE_PAGE_SIZE, true);
+}
+
+// ----------------- Pool (size classes) -----------------
+
+typedef struct pool_slab {
+    struct pool_slab *next;
+} pool_slab;
+
+typedef struct {
+    graph_allocator base;       // must stay first
+    void *free_list[POOL_CLASSES];
+    pool_slab *slabs;
+} pool_allocator;
+
+static int size_class(size_t size) {
+    int c = 0;
+    while (((size_t)1 << (c + POOL_MIN_SHIFT)) < size) {
+        c++;
+    }
+    return c;
+}
+
+static void *pool_alloc(graph_allocator *a, size_t size) {
+    pool_allocator *pool = (pool_allocator *)a;
+    int c = size_class(size ? size : 1);
+    if (c >= POOL_CLASSES) {
+        return calloc(1, size);
+    }
+    size_t block = (size_t)1 << (c + POOL_MIN_SHIFT);
+
+    if (pool->free_list[c] == NULL) {
+        // Carve a fresh slab into blocks of this class
+        size_t slab_bytes = block > POOL_SLAB_SIZE / 4 ? block * 4 : POOL_SLAB_SIZE;
+        pool_slab *slab = malloc(ALIGN_UP(sizeof(pool_slab)) + slab_bytes);
+        if (slab == NULL) {
+            return NULL;
+        }
+        slab->next = pool->slabs;
+        pool->slabs = slab;
+        unsigned char *first = (unsigned char *)slab + ALIGN_UP(sizeof(pool_slab));
+        for (size_t off = 0; off + block <= slab_bytes; off += block) {
+            *(void **)(first + off) = pool->free_list[c];
+            pool->free_list[c] = first + off;
+        }
+    }
+
+    void *p = pool->free_list[c];
+    pool->free_list[c] = *(void **)p;
+    memset(p, 0, block);
+    return p;
+}
+
+static void pool_free(graph_allocator *a, void *p, size_t size) {
+    pool_allocator *pool = (pool_allocator *)a;
+    if (p == NULL) {
+        return;
+    }
+    int c = size_class(size ? size : 1);
+    if (c >= POOL_CLASSES) {
+        free(p);
+        return;
+    }
+    *(void **)p = pool->free_list[c];
+    pool->free_list[c] = p;
+}
+
+static void pool_destroy(graph_allocator *a) {
+    pool_allocator *pool = (pool_allocator *)a;
+    pool_slab *slab = pool->slabs;
+    while (slab != NULL) {
+        pool_slab *next = slab->next;
+        free(slab);
+        slab = next;
+    }
+    free(pool);
+}
+
+// Size-class pool: freed blocks are recycled for later requests of the same
+// class, so repeated build/destroy cycles stop fragmenting the heap. Blocks
+// over 1 MiB go straight to malloc and must be freed individually.
+graph_allocator *create_pool_allocator(void) {
+    pool_allocator *pool = calloc(1, sizeof(*pool));
+    if (pool == NULL) {
+        return NULL;
+    }
+    pool->base.alloc = pool_alloc;
+    pool->base.release = pool_free;
+    pool->base.destroy = pool_destroy;
+    pool->base.releases_in_bulk = false;
+    return &pool->base;
+}
+
+// ----------------- Common entry points -----------------
+
+// Zeroed memory from 'a' (the heap allocator when NULL)
+void *allocator_alloc(graph_allocator *a, size_t size) {
+    if (a == NULL) {
+        a = heap_allocator();
+    }
+    return a->alloc(a, size);
+}
+
+// 'size' must be the size passed to allocator_alloc
+void allocator_free(graph_allocator *a, void *p, size_t size) {
+    if (a == NULL) {
+        a = heap_allocator();
+    }
+    a->release(a, p, size);
+}
+
+// Release everything the allocator handed out, then the allocator itself
+void destroy_allocator(graph_allocator *a) {
+    if (a != NULL && a->destroy != NULL) {
+        a->destroy(a);
+    }
+}
@@ -0,0 +1,415 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include "header.h"
+
+#define SEPARATION_LANDMARKS 8   // landmarks behind degrees_of_separation
+
+// Dijkstra over a whole CSR. 'order' (optional) receives the nodes in the
+// order they were settled and the return value is how many there are.
+static int full_dijkstra(csr_graph *c, int source, min_heap *h, int *dist, int *pred, int *order) {
+    for (int v = 0; v < c->numnodes; v++) {
+        dist[v] = INF;
+        if (pred) {
+            pred[v] = -1;
+        }
+    }
+    heap_clear(h);
+    dist[source] = 0;
+    heap_push(h, source, 0);
+    int settled = 0;
+    while (h->size > 0) {
+        int u = heap_pop(h);
+        if (order) {
+            order[settled] = u;
+        }
+        settled++;
+        for (int k = c->offsets[u]; k < c->offsets[u + 1]; k++) {
+            int v = c->targets[k];
+            int alt = dist[u] + (c->weights ? c->weights[k] : 1);
+            if (alt < dist[v]) {
+                dist[v] = alt;
+                if (pred) {
+                    pred[v] = u;
+                }
+                heap_push(h, v, alt);
+            }
+        }
+    }
+    return settled;
+}
+
+// Triangle-inequality lower bound on d(s, t) from the landmark tables.
+// INF means the tables prove t unreachable from s.
+static int landmark_bound(alt_index *alt, const int *s_from, const int *s_to,
+                          const int *t_from, const int *t_to) {
+    int best = 0;
+    for (int i = 0; i < alt->numlandmarks; i++) {
+        // d(L, t) <= d(L, s) + d(s, t)
+        if (s_from[i] != INF) {
+            if (t_from[i] == INF) {
+                return INF;     // L reaches s but not t
+            }
+            if (t_from[i] - s_from[i] > best) {
+                best = t_from[i] - s_from[i];
+            }
+        }
+        // d(s, L) <= d(s, t) + d(t, L)
+        if (t_to[i] != INF) {
+            if (s_to[i] == INF) {
+                return INF;     // t reaches L but s does not
+            }
+            if (s_to[i] - t_to[i] > best) {
+                best = s_to[i] - t_to[i];
+            }
+        }
+    }
+    return best;
+}
+
+// Fill the distance tables of landmark 'slot' (forward and backward)
+static void fill_landmark(alt_index *alt, csr_graph *c, csr_graph *t, int slot,
+                          min_heap *h, int *dist) {
+    int n = alt->numnodes, k = alt->numlandmarks;
+    full_dijkstra(c, alt->landmarks[slot], h, dist, NULL, NULL);
+    for (int v = 0; v < n; v++) {
+        alt->from[(size_t)v * k + slot] = dist[v];
+    }
+    full_dijkstra(t, alt->landmarks[slot], h, dist, NULL, NULL);
+    for (int v = 0; v < n; v++) {
+        alt->to[(size_t)v * k + slot] = dist[v];
+    }
+}
+
+// Farthest: the node whose round-trip distance to the chosen landmarks is
+// largest, preferring nodes no landmark connects to (another component)
+static int pick_farthest(alt_index *alt, int chosen, int *taken) {
+    int n = alt->numnodes, k = alt->numlandmarks;
+    int best = -1;
+    long long best_score = -1;
+    for (int v = 0; v < n; v++) {
+        if (taken[v]) {
+            continue;
+        }
+        long long score = (long long)INF * 2;
+        for (int i = 0; i < chosen; i++) {
+            int a = alt->from[(size_t)v * k + i], b = alt->to[(size_t)v * k + i];
+            long long d = (long long)(a == INF ? 0 : a) + (b == INF ? 0 : b);
+            if (a == INF && b == INF) {
+                d = (long long)INF * 2;
+            }
+            if (d < score) {
+                score = d;
+            }
+        }
+        if (score > best_score) {
+            best_score = score;
+            best = v;
+        }
+    }
+    return best;
+}
+
+// Avoid (Goldberg and Werneck): grow a shortest-path tree from a random
+// root, weigh each node by how badly the current landmarks bound its
+// distance, and descend from the heaviest landmark-free subtree to a leaf.
+static int pick_avoid(alt_index *alt, csr_graph *c, int chosen, int *taken, min_heap *h,
+                      unsigned long long *state, int *dist, int *pred, int *order,
+                      long long *size, int *child_offsets, int *children) {
+    int n = alt->numnodes, k = alt->numlandmarks;
+    int root = next_random(state) % n;
+    int settled = full_dijkstra(c, root, h, dist, pred, order);
+
+    // Subtree sizes bottom-up; subtrees holding a landmark weigh nothing
+    for (int i = 0; i < settled; i++) {
+        int v = order[i];
+        int bound = chosen > 0 ? landmark_bound(alt, alt->from + (size_t)root * k, alt->to + (size_t)root * k,
+                                                alt->from + (size_t)v * k, alt->to + (size_t)v * k) : 0;
+        size[v] = dist[v] - (bound == INF ? 0 : bound);
+    }
+    for (int i = settled - 1; i > 0; i--) {
+        int v = order[i];
+        if (taken[v]) {
+            size[v] = -1;
+        }
+        if (size[v] < 0) {
+            size[pred[v]] = -1;
+        } else if (size[pred[v]] >= 0) {
+            size[pred[v]] += size[v];
+        }
+    }
+
+    // Children lists of the tree, then the walk down
+    for (int v = 0; v <= n; v++) {
+        child_offsets[v] = 0;
+    }
+    for (int i = 1; i < settled; i++) {
+        child_offsets[pred[order[i]] + 1]++;
+    }
+    for (int v = 0; v < n; v++) {
+        child_offsets[v + 1] += child_offsets[v];
+    }
+    for (int i = 1; i < settled; i++) {
+        children[child_offsets[pred[order[i]]]++] = order[i];
+    }
+    for (int v = n; v > 0; v--) {
+        child_offsets[v] = child_offsets[v - 1];
+    }
+    child_offsets[0] = 0;
+
+    int v = -1;
+    for (int i = 0; i < settled; i++) {
+        if (!taken[order[i]] && size[order[i]] > 0 && (v < 0 || size[order[i]] > size[v])) {
+            v = order[i];
+        }
+    }
+    if (v < 0) {
+        return pick_farthest(alt, chosen, taken);
+    }
+    for (;;) {
+        int next = -1;
+        for (int j = child_offsets[v]; j < child_offsets[v + 1]; j++) {
+            int w = children[j];
+            if (size[w] >= 0 && (next < 0 || size[w] > size[next])) {
+                next = w;
+            }
+        }
+        if (next < 0) {
+            return v;
+        }
+        v = next;
+    }
+}
+
+// Landmark distance tables for ALT queries. 'numlandmarks' landmarks are
+// chosen with 'strategy'; each stores d(L, v) and d(v, L) for every node,
+// laid out node-major so one query touches k adjacent ints per node.
+alt_index *build_alt(csr_graph *c, int numlandmarks, landmark_strategy strategy, unsigned long long seed) {
+    assert(c != NULL);
+    int n = c->numnodes;
+    if (numlandmarks > n) {
+        numlandmarks = n;
+    }
+    alt_index *alt = calloc(1, sizeof(*alt));
+    if (alt == NULL) {
+        printf("Memory allocation failed\n");
+        return NULL;
+    }
+    alt->numnodes = n;
+    alt->numlandmarks = numlandmarks;
+    size_t cells = (size_t)n * numlandmarks > 0 ? (size_t)n * numlandmarks : 1;
+    alt->landmarks = malloc((numlandmarks > 0 ? numlandmarks : 1) * sizeof(int));
+    alt->from = malloc(cells * sizeof(int));
+    alt->to = malloc(cells * sizeof(int));
+
+    csr_graph *t = csr_transpose(c);
+    min_heap *h = create_min_heap(n);
+    int *taken = calloc(n > 0 ? n : 1, sizeof(int));
+    int *dist = malloc((n > 0 ? n : 1) * sizeof(int));
+    int *pred = malloc((n > 0 ? n : 1) * sizeof(int));
+    int *order = malloc((n > 0 ? n : 1) * sizeof(int));
+    int *child_offsets = malloc((n + 1) * sizeof(int));
+    int *children = malloc((n > 0 ? n : 1) * sizeof(int));
+    long long *size = malloc((n > 0 ? n : 1) * sizeof(long long));
+    bool ok = alt->landmarks && alt->from && alt->to && t && h && taken && dist &&
+              pred && order && child_offsets && children && size;
+
+    unsigned long long state = seed ? seed : 1;
+    for (int i = 0; ok && i < numlandmarks; i++) {
+        int landmark;
+        if (strategy == LANDMARK_AVOID) {
+            landmark = pick_avoid(alt, c, i, taken, h, &state, dist, pred, order, size,
+                                  child_offsets, children);
+        } else if (i == 0) {
+            landmark = next_random(&state) % n;
+        } else {
+            landmark = pick_farthest(alt, i, taken);
+        }
+        taken[landmark] = 1;
+        alt->landmarks[i] = landmark;
+        fill_landmark(alt, c, t, i, h, dist);
+    }
+
+    destroy_csr(t);
+    destroy_min_heap(h);
+    free(taken);
+    free(dist);
+    free(pred);
+    free(order);
+    free(child_offsets);
+    free(children);
+    free(size);
+    if (!ok) {
+        printf("Memory allocation failed\n");
+        destroy_alt(alt);
+        return NULL;
+    }
+    return alt;
+}
+
+void destroy_alt(alt_index *alt) {
+    if (alt != NULL) {
+        free(alt->landmarks);
+        free(alt->from);
+        free(alt->to);
+        free(alt);
+    }
+}
+
+// Distance oracle: bounds on d(start, end) in O(#landmarks) with no search.
+// The lower bound is INF when the tables prove 'end' unreachable; the upper
+// bound, the best detour through a landmark, is INF when none connects them.
+void alt_bounds(alt_index *alt, int start, int end, int *lower, int *upper) {
+    assert(alt != NULL);
+    int k = alt->numlandmarks;
+    const int *s_from = alt->from + (size_t)start * k, *s_to = alt->to + (size_t)start * k;
+    const int *t_from = alt->from + (size_t)end * k, *t_to = alt->to + (size_t)end * k;
+    if (lower) {
+        *lower = start == end ? 0 : landmark_bound(alt, s_from, s_to, t_from, t_to);
+    }
+    if (upper) {
+        int best = start == end ? 0 : INF;
+        for (int i = 0; i < k; i++) {
+            if (s_to[i] != INF && t_from[i] != INF && s_to[i] + t_from[i] < best) {
+                best = s_to[i] + t_from[i];
+            }
+        }
+        *upper = best;
+    }
+}
+
+// Per-thread query state, reset only where the previous query went
+alt_workspace *create_alt_workspace(int numnodes) {
+    alt_workspace *ws = calloc(1, sizeof(*ws));
+    if (ws == NULL) {
+        return NULL;
+    }
+    ws->dist = malloc((numnodes > 0 ? numnodes : 1) * sizeof(int));
+    ws->pred = malloc((numnodes > 0 ? numnodes : 1) * sizeof(int));
+    ws->touched = malloc((numnodes > 0 ? numnodes : 1) * sizeof(int));
+    ws->queue = create_min_heap(numnodes);
+    if (ws->dist == NULL || ws->pred == NULL || ws->touched == NULL || ws->queue == NULL) {
+        destroy_alt_workspace(ws);
+        return NULL;
+    }
+    for (int v = 0; v < numnodes; v++) {
+        ws->dist[v] = INF;
+    }
+    return ws;
+}
+
+void destroy_alt_workspace(alt_workspace *ws) {
+    if (ws != NULL) {
+        free(ws->dist);
+        free(ws->pred);
+        free(ws->touched);
+        destroy_min_heap(ws->queue);
+        free(ws);
+    }
+}
+
+// Exact distance from 'start' to 'end' by A* guided by the landmark bounds
+// (INF when unreachable). The bounds are consistent, so every node settles
+// once. If 'predecessors' is given the path is written into it for
+// print_path; only entries on the path are touched.
+int alt_query(alt_index *alt, csr_graph *c, alt_workspace *ws, int start, int end, int *predecessors) {
+    assert(alt != NULL && c != NULL && ws != NULL);
+    assert(start >= 0 && start < c->numnodes && end >= 0 && end < c->numnodes);
+    int k = alt->numlandmarks;
+    const int *t_from = alt->from + (size_t)end * k, *t_to = alt->to + (size_t)end * k;
+    for (int i = 0; i < ws->numtouched; i++) {
+        ws->dist[ws->touched[i]] = INF;
+    }
+    ws->numtouched = 0;
+    heap_clear(ws->queue);
+
+    int result = INF;
+    int h = landmark_bound(alt, alt->from + (size_t)start * k, alt->to + (size_t)start * k, t_from, t_to);
+    if (h != INF) {
+        ws->dist[start] = 0;
+        ws->pred[start] = -1;
+        ws->touched[ws->numtouched++] = start;
+        heap_push(ws->queue, start, h);
+    }
+    while (ws->queue->size > 0) {
+        int u = heap_pop(ws->queue);
+        int du = ws->dist[u];
+        if (u == end) {
+            result = du;
+            break;
+        }
+        for (int e = c->offsets[u]; e < c->offsets[u + 1]; e++) {
+            int v = c->targets[e];
+            int alt_dist = du + (c->weights ? c->weights[e] : 1);
+            if (alt_dist >= ws->dist[v]) {
+                continue;
+            }
+            int bound = landmark_bound(alt, alt->from + (size_t)v * k, alt->to + (size_t)v * k, t_from, t_to);
+            if (bound == INF) {
+                continue;       // v provably cannot reach the target
+            }
+            if (ws->dist[v] == INF) {
+                ws->touched[ws->numtouched++] = v;
+            }
+            ws->dist[v] = alt_dist;
+            ws->pred[v] = u;
+            heap_push(ws->queue, v, alt_dist + bound);
+        }
+    }
+
+    if (predecessors != NULL) {
+        predecessors[start] = -1;
+        if (result == INF) {
+            if (end != start) {
+                predecessors[end] = -1;
+            }
+        } else {
+            for (int v = end; v != start; v = ws->pred[v]) {
+                predecessors[v] = ws->pred[v];
+            }
+        }
+    }
+    return result;
+}
+
+// Degrees of separation between two users, following friendships either
+// way. The undirected view, the landmark index and the query workspace are
+// built on first use and kept by the caller until the network changes, so
+// each request is a short A* search instead of a full Dijkstra.
+void degrees_of_separation(graph *g, csr_graph **view, alt_index **index,
+                           alt_workspace **workspace, int from, int to) {
+    assert(g != NULL && view != NULL && index != NULL && workspace != NULL);
+    if (from < 0 || from >= g->numnodes || to < 0 || to >= g->numnodes) {
+        printf("Invalid user IDs. Please try again.\n");
+        return;
+    }
+    if (*index == NULL) {
+        *view = build_csr_undirected(g);
+        *index = *view ? build_alt(*view, SEPARATION_LANDMARKS, LANDMARK_AVOID, 1) : NULL;
+        if (*index == NULL) {
+            printf("Failed to build the landmark index.\n");
+            destroy_csr(*view);
+            *view = NULL;
+            return;
+        }
+    }
+    if (*workspace == NULL) {
+        *workspace = create_alt_workspace(g->numnodes);
+        if (*workspace == NULL) {
+            printf("Failed to compute degrees of separation.\n");
+            return;
+        }
+    }
+
+    // The workspace's predecessors are valid along the path just found
+    alt_workspace *ws = *workspace;
+    int degrees = alt_query(*index, *view, ws, from, to, NULL);
+    if (degrees == INF) {
+        printf("User %d and User %d are not connected.\n", from, to);
+    } else {
+        printf("Degrees of separation between User %d and User %d: %d\n", from, to, degrees);
+        printf("Chain: ");
+        print_path(ws->pred, from, to);
+        printf("\n");
+    }
+}
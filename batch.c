@@ -0,0 +1,273 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <assert.h>
+#include "header.h"
+
+// Sources traversed together by one bit-parallel BFS (one bit each)
+#define BATCH_WIDTH 64
+
+// Multi-source BFS for up to 64 sources sharing one pass over the graph:
+// seen/frontier/next hold one bit per source for every node, so a neighbor
+// list is read once per level for all sources whose frontier contains it.
+static bool bfs_batch(csr_graph *c, const int *sources, int count, int *dist) {
+    int n = c->numnodes;
+    uint64_t *seen = calloc(n, sizeof(uint64_t));
+    uint64_t *frontier = calloc(n, sizeof(uint64_t));
+    uint64_t *next = calloc(n, sizeof(uint64_t));
+    if (seen == NULL || frontier == NULL || next == NULL) {
+        free(seen);
+        free(frontier);
+        free(next);
+        return false;
+    }
+
+    for (int i = 0; i < count; i++) {
+        int *row = dist + (size_t)i * n;
+        for (int v = 0; v < n; v++) {
+            row[v] = INF;
+        }
+        uint64_t bit = (uint64_t)1 << i;
+        seen[sources[i]] |= bit;
+        frontier[sources[i]] |= bit;
+        row[sources[i]] = 0;
+    }
+
+    bool active = true;
+    for (int level = 1; active; level++) {
+        active = false;
+        for (int v = 0; v < n; v++) {
+            uint64_t f = frontier[v];
+            if (f == 0) {
+                continue;
+            }
+            for (int k = c->offsets[v]; k < c->offsets[v + 1]; k++) {
+                next[c->targets[k]] |= f;
+            }
+        }
+        for (int w = 0; w < n; w++) {
+            uint64_t fresh = next[w] & ~seen[w];
+            next[w] = 0;
+            frontier[w] = fresh;
+            if (fresh == 0) {
+                continue;
+            }
+            seen[w] |= fresh;
+            active = true;
+            while (fresh) {
+                int i = __builtin_ctzll(fresh);
+                dist[(size_t)i * n + w] = level;
+                fresh &= fresh - 1;
+            }
+        }
+    }
+
+    free(seen);
+    free(frontier);
+    free(next);
+    return true;
+}
+
+typedef struct {
+    csr_graph *c;
+    const int *sources;
+    int numsources;
+    int *dist;
+    bool failed;
+} bfs_job;
+
+static void bfs_batches(int begin, int end, int worker, void *arg) {
+    bfs_job *job = arg;
+    int n = job->c->numnodes;
+    for (int b = begin; b < end; b++) {
+        int first = b * BATCH_WIDTH;
+        int count = job->numsources - first < BATCH_WIDTH ? job->numsources - first : BATCH_WIDTH;
+        if (!bfs_batch(job->c, job->sources + first, count, job->dist + (size_t)first * n)) {
+            __atomic_store_n(&job->failed, true, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+// Hop distances from every source: row i of the returned numsources x
+// numnodes matrix holds the BFS distances from sources[i] (INF when
+// unreachable). Sources are processed 64 at a time, batches in parallel.
+int *batch_bfs(csr_graph *c, const int *sources, int numsources) {
+    assert(c != NULL && sources != NULL);
+    int n = c->numnodes;
+    int *dist = malloc(((size_t)numsources * n > 0 ? (size_t)numsources * n : 1) * sizeof(int));
+    if (dist == NULL) {
+        printf("Memory allocation failed\n");
+        return NULL;
+    }
+
+    int numbatches = (numsources + BATCH_WIDTH - 1) / BATCH_WIDTH;
+    bfs_job job = {c, sources, numsources, dist, false};
+    parallel_for(0, numbatches, 1, bfs_batches, &job);
+    if (job.failed) {
+        printf("Memory allocation failed\n");
+        free(dist);
+        return NULL;
+    }
+    return dist;
+}
+
+// Dijkstra from every source in 'sources' seeded at distance 0 together.
+// 'nearest' (optional) receives the index into 'sources' of the closest
+// source of each node, -1 if none reaches it.
+static bool seeded_dijkstra(csr_graph *c, const int *sources, int numsources, min_heap *h,
+                            int *dist, int *nearest) {
+    int n = c->numnodes;
+    for (int v = 0; v < n; v++) {
+        dist[v] = INF;
+        if (nearest) {
+            nearest[v] = -1;
+        }
+    }
+    heap_clear(h);
+    for (int i = 0; i < numsources; i++) {
+        int s = sources[i];
+        if (dist[s] != 0) {
+            dist[s] = 0;
+            if (nearest) {
+                nearest[s] = i;
+            }
+            heap_push(h, s, 0);
+        }
+    }
+
+    while (h->size > 0) {
+        int u = heap_pop(h);
+        int du = dist[u];
+        for (int k = c->offsets[u]; k < c->offsets[u + 1]; k++) {
+            int v = c->targets[k];
+            int alt = du + (c->weights ? c->weights[k] : 1);
+            if (alt < dist[v]) {
+                dist[v] = alt;
+                if (nearest) {
+                    nearest[v] = nearest[u];
+                }
+                heap_push(h, v, alt);
+            }
+        }
+    }
+    return true;
+}
+
+// "Nearest facility": one Dijkstra from all sources at once. Returns the
+// distance from each node's closest source; 'nearest' (optional) gets which
+// source that is as an index into 'sources'.
+int *multi_source_dijkstra(csr_graph *c, const int *sources, int numsources, int *nearest) {
+    assert(c != NULL && sources != NULL);
+    int *dist = malloc((c->numnodes > 0 ? c->numnodes : 1) * sizeof(int));
+    min_heap *h = create_min_heap(c->numnodes);
+    if (dist == NULL || h == NULL) {
+        printf("Memory allocation failed\n");
+        free(dist);
+        destroy_min_heap(h);
+        return NULL;
+    }
+    seeded_dijkstra(c, sources, numsources, h, dist, nearest);
+    destroy_min_heap(h);
+    return dist;
+}
+
+typedef struct {
+    csr_graph *c;
+    const int *sources;
+    int *dist;
+    min_heap **heaps;   // one per worker
+} dijkstra_job;
+
+static void dijkstra_sources(int begin, int end, int worker, void *arg) {
+    dijkstra_job *job = arg;
+    int n = job->c->numnodes;
+    for (int i = begin; i < end; i++) {
+        seeded_dijkstra(job->c, job->sources + i, 1, job->heaps[worker], job->dist + (size_t)i * n,
+                        NULL);
+    }
+}
+
+// Weighted distance matrix: row i holds Dijkstra distances from sources[i].
+// Sources run in parallel, each worker reusing one heap.
+int *batch_dijkstra(csr_graph *c, const int *sources, int numsources) {
+    assert(c != NULL && sources != NULL);
+    int n = c->numnodes;
+    int numworkers = scheduler_acquire();
+    int *dist = malloc(((size_t)numsources * n > 0 ? (size_t)numsources * n : 1) * sizeof(int));
+    min_heap **heaps = calloc(numworkers, sizeof(min_heap *));
+    bool ok = dist != NULL && heaps != NULL;
+    for (int w = 0; ok && w < numworkers; w++) {
+        heaps[w] = create_min_heap(n);
+        ok = heaps[w] != NULL;
+    }
+
+    if (ok) {
+        dijkstra_job job = {c, sources, dist, heaps};
+        parallel_for(0, numsources, 1, dijkstra_sources, &job);
+    }
+    for (int w = 0; heaps != NULL && w < numworkers; w++) {
+        destroy_min_heap(heaps[w]);
+    }
+    free(heaps);
+    scheduler_release();
+    if (!ok) {
+        printf("Memory allocation failed\n");
+        free(dist);
+        return NULL;
+    }
+    return dist;
+}
+
+typedef struct {
+    const int *dist;
+    int numnodes;
+    int max_per_user;
+    int *out;
+    int *counts;
+} recommend_job;
+
+static void recommend_users(int begin, int end, int worker, void *arg) {
+    recommend_job *job = arg;
+    int n = job->numnodes, max_per_user = job->max_per_user;
+    for (int i = begin; i < end; i++) {
+        const int *row = job->dist + (size_t)i * n;
+        int *picks = job->out + (size_t)i * max_per_user;
+        int found = 0;
+        for (int v = 0; v < n; v++) {
+            if (row[v] < 2 || row[v] == INF) {
+                continue;
+            }
+            // Insert into the sorted top list, dropping the worst when full
+            int pos = found < max_per_user ? found++ : max_per_user;
+            while (pos > 0 && row[picks[pos - 1]] > row[v]) {
+                if (pos < max_per_user) {
+                    picks[pos] = picks[pos - 1];
+                }
+                pos--;
+            }
+            if (pos < max_per_user) {
+                picks[pos] = v;
+            }
+        }
+        job->counts[i] = found;
+    }
+}
+
+// Friend recommendations for many users from one batched BFS. Candidates
+// are reachable non-friends (distance >= 2), closest first, then by id.
+// Row i of 'out' (numusers x max_per_user) gets the picks for users[i] and
+// counts[i] how many there are. Returns false on allocation failure.
+bool batch_recommend(csr_graph *c, const int *users, int numusers, int max_per_user,
+                     int *out, int *counts) {
+    assert(c != NULL && users != NULL && out != NULL && counts != NULL);
+    int n = c->numnodes;
+    int *dist = batch_bfs(c, users, numusers);
+    if (dist == NULL) {
+        return false;
+    }
+
+    recommend_job job = {dist, n, max_per_user, out, counts};
+    parallel_for(0, numusers, 16, recommend_users, &job);
+    free(dist);
+    return true;
+}
@@ -0,0 +1,290 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+#include "header.h"
+
+typedef struct {
+    csr_graph *in;
+    const int *out_degree;
+    int seed;
+    double damping;
+    double restart;
+    double *rank;
+    double *next;
+    double *contrib;
+} power_job;
+
+// contrib[u] = rank[u] / outdeg[u]; accumulates the rank of dangling nodes
+static void scatter_contributions(int begin, int end, int worker, void *accumulator, void *arg) {
+    power_job *job = arg;
+    double dangling = 0.0;
+    for (int u = begin; u < end; u++) {
+        if (job->out_degree[u] == 0) {
+            dangling += job->rank[u];
+            job->contrib[u] = 0.0;
+        } else {
+            job->contrib[u] = job->rank[u] / job->out_degree[u];
+        }
+    }
+    *(double *)accumulator += dangling;
+}
+
+// next[v] from the in-neighbors' contributions; accumulates the L1 change
+static void gather_contributions(int begin, int end, int worker, void *accumulator, void *arg) {
+    power_job *job = arg;
+    csr_graph *in = job->in;
+    int n = in->numnodes;
+    double diff = 0.0;
+    for (int v = begin; v < end; v++) {
+        double sum = 0.0;
+        for (int k = in->offsets[v]; k < in->offsets[v + 1]; k++) {
+            sum += job->contrib[in->targets[k]];
+        }
+        double teleport = job->seed < 0 ? 1.0 / n : (v == job->seed ? 1.0 : 0.0);
+        job->next[v] = job->damping * sum + job->restart * teleport;
+        diff += fabs(job->next[v] - job->rank[v]);
+    }
+    *(double *)accumulator += diff;
+}
+
+// Power iteration over the in-edge CSR (pull-based SpMV). Each iteration
+// computes next[v] = d * sum(rank[u] / outdeg[u] for u -> v) + teleport, where
+// the teleport term also carries the mass of dangling nodes. 'seed' < 0 uses
+// the uniform restart vector, otherwise all restarts go to 'seed'.
+static double *power_iterate(csr_graph *in, const int *out_degree, int seed,
+                             double damping, double tolerance, int max_iterations) {
+    int n = in->numnodes;
+    double *rank = malloc(n * sizeof(double));
+    double *next = malloc(n * sizeof(double));
+    double *contrib = malloc(n * sizeof(double));
+    if (rank == NULL || next == NULL || contrib == NULL) {
+        printf("Memory allocation failed\n");
+        free(rank);
+        free(next);
+        free(contrib);
+        return NULL;
+    }
+
+    for (int v = 0; v < n; v++) {
+        rank[v] = seed < 0 ? 1.0 / n : (v == seed ? 1.0 : 0.0);
+    }
+
+    power_job job = {in, out_degree, seed, damping, 0.0, rank, next, contrib};
+    for (int iter = 0; iter < max_iterations; iter++) {
+        job.rank = rank;
+        job.next = next;
+        double dangling = 0.0;
+        bool ok = parallel_reduce(0, n, 0, &dangling, sizeof(double), scatter_contributions,
+                                  reduce_sum_double, &job);
+
+        // Mass that restarts this round: random jumps plus dangling rank
+        job.restart = (1.0 - damping) + damping * dangling;
+        double diff = 0.0;
+        ok = ok && parallel_reduce(0, n, 256, &diff, sizeof(double), gather_contributions,
+                                   reduce_sum_double, &job);
+        if (!ok) {
+            free(rank);
+            free(next);
+            free(contrib);
+            return NULL;
+        }
+
+        double *tmp = rank;
+        rank = next;
+        next = tmp;
+        if (diff < tolerance) {
+            break;
+        }
+    }
+
+    free(next);
+    free(contrib);
+    return rank;
+}
+
+static double *run_pagerank(graph *g, int seed, double damping, double tolerance, int max_iterations) {
+    csr_graph *in = build_csr_transpose(g);
+    int *out_degree = calloc(g->numnodes, sizeof(int));
+    if (in == NULL || out_degree == NULL) {
+        printf("Memory allocation failed\n");
+        destroy_csr(in);
+        free(out_degree);
+        return NULL;
+    }
+
+    for (int k = 0; k < in->numedges; k++) {
+        out_degree[in->targets[k]]++;
+    }
+
+    double *rank = power_iterate(in, out_degree, seed, damping, tolerance, max_iterations);
+    destroy_csr(in);
+    free(out_degree);
+    return rank;
+}
+
+// PageRank of every node; scores sum to 1. Iterates until the L1 change
+// drops below 'tolerance' or 'max_iterations' is reached.
+double *pagerank(graph *g, double damping, double tolerance, int max_iterations) {
+    assert(g != NULL);
+    if (g->numnodes == 0) {
+        return NULL;
+    }
+    return run_pagerank(g, -1, damping, tolerance, max_iterations);
+}
+
+// PageRank with every restart going to 'seed': scores measure proximity to it
+double *personalized_pagerank(graph *g, int seed, double damping, double tolerance, int max_iterations) {
+    assert(g != NULL);
+    assert(seed >= 0 && seed < g->numnodes);
+    return run_pagerank(g, seed, damping, tolerance, max_iterations);
+}
+
+// One Brandes pass from 'source': BFS counting shortest paths, then
+// dependencies are accumulated in reverse BFS order into 'centrality'.
+static void brandes_source(csr_graph *out, csr_graph *in, int source, int *dist, double *sigma,
+                           double *delta, int *order, double *centrality) {
+    int n = out->numnodes;
+    for (int v = 0; v < n; v++) {
+        dist[v] = -1;
+        sigma[v] = 0.0;
+        delta[v] = 0.0;
+    }
+
+    int front = 0, rear = 0;
+    dist[source] = 0;
+    sigma[source] = 1.0;
+    order[rear++] = source;
+    while (front < rear) {
+        int u = order[front++];
+        for (int k = out->offsets[u]; k < out->offsets[u + 1]; k++) {
+            int v = out->targets[k];
+            if (dist[v] < 0) {
+                dist[v] = dist[u] + 1;
+                order[rear++] = v;
+            }
+            if (dist[v] == dist[u] + 1) {
+                sigma[v] += sigma[u];
+            }
+        }
+    }
+
+    // Predecessors on shortest paths are the in-neighbors one level closer
+    for (int i = rear - 1; i > 0; i--) {
+        int w = order[i];
+        for (int k = in->offsets[w]; k < in->offsets[w + 1]; k++) {
+            int v = in->targets[k];
+            if (dist[v] >= 0 && dist[v] == dist[w] - 1) {
+                delta[v] += sigma[v] / sigma[w] * (1.0 + delta[w]);
+            }
+        }
+        centrality[w] += delta[w];
+    }
+}
+
+typedef struct {
+    int *dist;
+    int *order;
+    double *sigma;
+    double *delta;
+    double *local;
+} brandes_scratch;
+
+typedef struct {
+    csr_graph *out;
+    csr_graph *in;
+    const int *sources;
+    brandes_scratch *scratch;   // one per worker
+} brandes_job;
+
+static void brandes_sources(int begin, int end, int worker, void *arg) {
+    brandes_job *job = arg;
+    brandes_scratch *b = &job->scratch[worker];
+    for (int i = begin; i < end; i++) {
+        brandes_source(job->out, job->in, job->sources[i], b->dist, b->sigma, b->delta, b->order,
+                       b->local);
+    }
+}
+
+// Betweenness centrality estimated from 'samples' random BFS sources and
+// scaled by numnodes / samples. With samples >= numnodes every node is a
+// source and the result is exact.
+double *approximate_betweenness(graph *g, int samples, unsigned long long seed) {
+    assert(g != NULL);
+    int n = g->numnodes;
+    if (n == 0 || samples <= 0) {
+        return NULL;
+    }
+
+    bool exact = samples >= n;
+    if (exact) {
+        samples = n;
+    }
+
+    csr_graph *out = build_csr(g);
+    csr_graph *in = build_csr_transpose(g);
+    double *centrality = calloc(n, sizeof(double));
+    int *sources = malloc(samples * sizeof(int));
+    if (out == NULL || in == NULL || centrality == NULL || sources == NULL) {
+        printf("Memory allocation failed\n");
+        destroy_csr(out);
+        destroy_csr(in);
+        free(centrality);
+        free(sources);
+        return NULL;
+    }
+
+    unsigned long long state = seed ? seed : 1;
+    for (int i = 0; i < samples; i++) {
+        sources[i] = exact ? i : (int)(next_random(&state) % n);
+    }
+
+    // Per-worker traversal buffers and partial sums, merged at the end
+    int numworkers = scheduler_acquire();
+    brandes_scratch *scratch = calloc(numworkers, sizeof(brandes_scratch));
+    bool ok = scratch != NULL;
+    for (int w = 0; ok && w < numworkers; w++) {
+        brandes_scratch *b = &scratch[w];
+        b->dist = malloc(n * sizeof(int));
+        b->order = malloc(n * sizeof(int));
+        b->sigma = malloc(n * sizeof(double));
+        b->delta = malloc(n * sizeof(double));
+        b->local = calloc(n, sizeof(double));
+        ok = b->dist && b->order && b->sigma && b->delta && b->local;
+    }
+
+    if (ok) {
+        brandes_job job = {out, in, sources, scratch};
+        parallel_for(0, samples, 1, brandes_sources, &job);
+        for (int w = 0; w < numworkers; w++) {
+            for (int v = 0; v < n; v++) {
+                centrality[v] += scratch[w].local[v];
+            }
+        }
+    }
+    for (int w = 0; scratch != NULL && w < numworkers; w++) {
+        free(scratch[w].dist);
+        free(scratch[w].order);
+        free(scratch[w].sigma);
+        free(scratch[w].delta);
+        free(scratch[w].local);
+    }
+    free(scratch);
+    scheduler_release();
+
+    destroy_csr(out);
+    destroy_csr(in);
+    free(sources);
+    if (!ok) {
+        printf("Memory allocation failed\n");
+        free(centrality);
+        return NULL;
+    }
+
+    double scale = (double)n / samples;
+    for (int v = 0; v < n; v++) {
+        centrality[v] *= scale;
+    }
+    return centrality;
+}
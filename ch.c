@@ -0,0 +1,621 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include "header.h"
+
+// Witness searches give up after settling this many nodes; a missed witness
+// only costs a redundant shortcut, never a wrong distance.
+#define WITNESS_SETTLE_LIMIT 500
+
+#define CH_MAGIC 0x58494843     // "CHIX"
+#define CH_VERSION 1
+
+typedef struct {
+    int node;
+    int weight;
+    int middle;     // contracted node a shortcut bypasses, -1 for an original edge
+} ch_arc;
+
+// Growable arc list of one node during preprocessing
+typedef struct {
+    ch_arc *arcs;
+    int count;
+    int capacity;
+} arc_list;
+
+typedef struct {
+    int numnodes;
+    arc_list *out;
+    arc_list *in;
+    bool *contracted;
+    int *deleted_neighbors;
+    // Witness search scratch, reset through 'touched'
+    int *dist;
+    int *touched;
+    int numtouched;
+    min_heap *heap;
+} ch_builder;
+
+// Add u->v with 'weight', or lower the weight of the existing arc
+static bool add_or_lower(arc_list *list, int node, int weight, int middle) {
+    for (int i = 0; i < list->count; i++) {
+        if (list->arcs[i].node == node) {
+            if (weight < list->arcs[i].weight) {
+                list->arcs[i].weight = weight;
+                list->arcs[i].middle = middle;
+            }
+            return true;
+        }
+    }
+    if (list->count == list->capacity) {
+        int capacity = list->capacity ? list->capacity * 2 : 4;
+        ch_arc *arcs = realloc(list->arcs, capacity * sizeof(ch_arc));
+        if (arcs == NULL) {
+            return false;
+        }
+        list->arcs = arcs;
+        list->capacity = capacity;
+    }
+    list->arcs[list->count++] = (ch_arc){ node, weight, middle };
+    return true;
+}
+
+// Bounded Dijkstra from 'source' that never enters 'skip' or contracted
+// nodes, stopping once every remaining key exceeds 'limit'
+static void witness_search(ch_builder *b, int source, int skip, int limit) {
+    for (int i = 0; i < b->numtouched; i++) {
+        b->dist[b->touched[i]] = INF;
+    }
+    b->numtouched = 0;
+    heap_clear(b->heap);
+
+    b->dist[source] = 0;
+    b->touched[b->numtouched++] = source;
+    heap_push(b->heap, source, 0);
+    int settled = 0;
+    while (b->heap->size > 0 && settled < WITNESS_SETTLE_LIMIT) {
+        int u = heap_pop(b->heap);
+        int du = b->dist[u];
+        if (du > limit) {
+            break;
+        }
+        settled++;
+        arc_list *out = &b->out[u];
+        for (int i = 0; i < out->count; i++) {
+            int v = out->arcs[i].node;
+            if (v == skip || b->contracted[v]) {
+                continue;
+            }
+            int alt = du + out->arcs[i].weight;
+            if (alt < b->dist[v]) {
+                if (b->dist[v] == INF) {
+                    b->touched[b->numtouched++] = v;
+                }
+                b->dist[v] = alt;
+                heap_push(b->heap, v, alt);
+            }
+        }
+    }
+}
+
+// Shortcuts needed to contract v; with 'apply' set they are also inserted.
+// Returns -1 on allocation failure.
+static int contract_node(ch_builder *b, int v, bool apply) {
+    arc_list *in = &b->in[v];
+    arc_list *out = &b->out[v];
+    int shortcuts = 0;
+
+    for (int i = 0; i < in->count; i++) {
+        int u = in->arcs[i].node;
+        if (b->contracted[u]) {
+            continue;
+        }
+        int w1 = in->arcs[i].weight;
+        int max_out = -1;
+        for (int j = 0; j < out->count; j++) {
+            int x = out->arcs[j].node;
+            if (x != u && !b->contracted[x] && out->arcs[j].weight > max_out) {
+                max_out = out->arcs[j].weight;
+            }
+        }
+        if (max_out < 0) {
+            continue;
+        }
+
+        witness_search(b, u, v, w1 + max_out);
+        for (int j = 0; j < out->count; j++) {
+            int x = out->arcs[j].node;
+            if (x == u || b->contracted[x]) {
+                continue;
+            }
+            int via = w1 + out->arcs[j].weight;
+            if (b->dist[x] <= via) {
+                continue;   // witness path avoids v
+            }
+            shortcuts++;
+            if (apply && (!add_or_lower(&b->out[u], x, via, v) || !add_or_lower(&b->in[x], u, via, v))) {
+                return -1;
+            }
+        }
+    }
+    return shortcuts;
+}
+
+// Edge difference plus already-contracted neighbors, which spreads the
+// contraction evenly over the graph
+static int contraction_priority(ch_builder *b, int v) {
+    int degree = 0;
+    for (int i = 0; i < b->in[v].count; i++) {
+        degree += !b->contracted[b->in[v].arcs[i].node];
+    }
+    for (int i = 0; i < b->out[v].count; i++) {
+        degree += !b->contracted[b->out[v].arcs[i].node];
+    }
+    return contract_node(b, v, false) - degree + b->deleted_neighbors[v];
+}
+
+static int compare_arcs(const void *a, const void *b) {
+    const ch_arc *x = a, *y = b;
+    return (x->node > y->node) - (x->node < y->node);
+}
+
+// Collect, per node, the arcs of 'lists' leading to higher-ranked nodes into
+// a weighted CSR with rows sorted by target
+static csr_graph *upward_csr(arc_list *lists, int n, const int *rank, int **middle) {
+    int m = 0;
+    for (int u = 0; u < n; u++) {
+        for (int i = 0; i < lists[u].count; i++) {
+            m += rank[lists[u].arcs[i].node] > rank[u];
+        }
+    }
+
+    csr_graph *c = malloc(sizeof(*c));
+    ch_arc *row = malloc((m > 0 ? m : 1) * sizeof(ch_arc));
+    *middle = malloc((m > 0 ? m : 1) * sizeof(int));
+    if (c != NULL) {
+        c->numnodes = n;
+        c->numedges = m;
+        c->offsets = malloc((n + 1) * sizeof(int));
+        c->targets = malloc((m > 0 ? m : 1) * sizeof(int));
+        c->weights = malloc((m > 0 ? m : 1) * sizeof(int));
+    }
+    if (c == NULL || row == NULL || *middle == NULL ||
+        c->offsets == NULL || c->targets == NULL || c->weights == NULL) {
+        destroy_csr(c);
+        free(row);
+        free(*middle);
+        *middle = NULL;
+        return NULL;
+    }
+
+    int k = 0;
+    for (int u = 0; u < n; u++) {
+        c->offsets[u] = k;
+        int count = 0;
+        for (int i = 0; i < lists[u].count; i++) {
+            if (rank[lists[u].arcs[i].node] > rank[u]) {
+                row[count++] = lists[u].arcs[i];
+            }
+        }
+        qsort(row, count, sizeof(ch_arc), compare_arcs);
+        for (int i = 0; i < count; i++, k++) {
+            c->targets[k] = row[i].node;
+            c->weights[k] = row[i].weight;
+            (*middle)[k] = row[i].middle;
+        }
+    }
+    c->offsets[n] = k;
+    free(row);
+    return c;
+}
+
+static void free_builder(ch_builder *b) {
+    if (b->out != NULL) {
+        for (int v = 0; v < b->numnodes; v++) {
+            free(b->out[v].arcs);
+        }
+    }
+    if (b->in != NULL) {
+        for (int v = 0; v < b->numnodes; v++) {
+            free(b->in[v].arcs);
+        }
+    }
+    free(b->out);
+    free(b->in);
+    free(b->contracted);
+    free(b->deleted_neighbors);
+    free(b->dist);
+    free(b->touched);
+    destroy_min_heap(b->heap);
+}
+
+static ch_index *alloc_ch(int numnodes) {
+    ch_index *ch = calloc(1, sizeof(*ch));
+    if (ch == NULL) {
+        return NULL;
+    }
+    ch->numnodes = numnodes;
+    ch->rank = malloc((numnodes > 0 ? numnodes : 1) * sizeof(int));
+    if (ch->rank == NULL) {
+        free(ch);
+        return NULL;
+    }
+    return ch;
+}
+
+// Contraction hierarchy of a weighted directed CSR (unit weights when
+// c->weights is NULL). Nodes are contracted by lazily updated priority;
+// each contraction adds the shortcuts its witness searches cannot rule out.
+// Preprocessing is meant to run offline, see save_ch/load_ch.
+ch_index *build_ch(csr_graph *c) {
+    assert(c != NULL);
+    int n = c->numnodes;
+    ch_builder b = { n };
+    b.out = calloc(n > 0 ? n : 1, sizeof(arc_list));
+    b.in = calloc(n > 0 ? n : 1, sizeof(arc_list));
+    b.contracted = calloc(n > 0 ? n : 1, sizeof(bool));
+    b.deleted_neighbors = calloc(n > 0 ? n : 1, sizeof(int));
+    b.dist = malloc((n > 0 ? n : 1) * sizeof(int));
+    b.touched = malloc((n > 0 ? n : 1) * sizeof(int));
+    b.heap = create_min_heap(n);
+    min_heap *order = create_min_heap(n);
+    ch_index *ch = alloc_ch(n);
+    bool ok = b.out && b.in && b.contracted && b.deleted_neighbors && b.dist &&
+              b.touched && b.heap && order && ch;
+
+    for (int v = 0; ok && v < n; v++) {
+        b.dist[v] = INF;
+        for (int k = c->offsets[v]; ok && k < c->offsets[v + 1]; k++) {
+            int w = c->weights ? c->weights[k] : 1;
+            if (c->targets[k] != v) {
+                ok = add_or_lower(&b.out[v], c->targets[k], w, -1) &&
+                     add_or_lower(&b.in[c->targets[k]], v, w, -1);
+            }
+        }
+    }
+
+    for (int v = 0; ok && v < n; v++) {
+        heap_push(order, v, contraction_priority(&b, v));
+    }
+
+    int next_rank = 0;
+    while (ok && order->size > 0) {
+        int v = heap_pop(order);
+        int priority = contraction_priority(&b, v);
+        if (order->size > 0 && priority > order->keys[order->nodes[0]]) {
+            heap_push(order, v, priority);     // stale key, try again later
+            continue;
+        }
+        if (contract_node(&b, v, true) < 0) {
+            ok = false;
+            break;
+        }
+        b.contracted[v] = true;
+        ch->rank[v] = next_rank++;
+        for (int i = 0; i < b.in[v].count; i++) {
+            b.deleted_neighbors[b.in[v].arcs[i].node]++;
+        }
+        for (int i = 0; i < b.out[v].count; i++) {
+            b.deleted_neighbors[b.out[v].arcs[i].node]++;
+        }
+    }
+
+    if (ok) {
+        ch->up = upward_csr(b.out, n, ch->rank, &ch->up_middle);
+        ch->down = upward_csr(b.in, n, ch->rank, &ch->down_middle);
+        ok = ch->up != NULL && ch->down != NULL;
+    }
+    free_builder(&b);
+    destroy_min_heap(order);
+    if (!ok) {
+        printf("Memory allocation failed\n");
+        destroy_ch(ch);
+        return NULL;
+    }
+    return ch;
+}
+
+void destroy_ch(ch_index *ch) {
+    if (ch != NULL) {
+        free(ch->rank);
+        destroy_csr(ch->up);
+        destroy_csr(ch->down);
+        free(ch->up_middle);
+        free(ch->down_middle);
+        free(ch);
+    }
+}
+
+// ----------------- Serialized index -----------------
+
+static bool write_ints(FILE *f, const int *values, int count) {
+    return count == 0 || fwrite(values, sizeof(int), count, f) == (size_t)count;
+}
+
+static bool read_ints(FILE *f, int *values, int count) {
+    return count == 0 || fread(values, sizeof(int), count, f) == (size_t)count;
+}
+
+// Write the index to 'filename' in native byte order
+bool save_ch(ch_index *ch, const char *filename) {
+    assert(ch != NULL);
+    FILE *f = fopen(filename, "wb");
+    if (f == NULL) {
+        return false;
+    }
+    int n = ch->numnodes;
+    int header[5] = { CH_MAGIC, CH_VERSION, n, ch->up->numedges, ch->down->numedges };
+    bool ok = write_ints(f, header, 5) && write_ints(f, ch->rank, n) &&
+              write_ints(f, ch->up->offsets, n + 1) &&
+              write_ints(f, ch->up->targets, ch->up->numedges) &&
+              write_ints(f, ch->up->weights, ch->up->numedges) &&
+              write_ints(f, ch->up_middle, ch->up->numedges) &&
+              write_ints(f, ch->down->offsets, n + 1) &&
+              write_ints(f, ch->down->targets, ch->down->numedges) &&
+              write_ints(f, ch->down->weights, ch->down->numedges) &&
+              write_ints(f, ch->down_middle, ch->down->numedges);
+    return fclose(f) == 0 && ok;
+}
+
+static csr_graph *read_csr(FILE *f, int n, int m, int **middle) {
+    csr_graph *c = malloc(sizeof(*c));
+    *middle = malloc((m > 0 ? m : 1) * sizeof(int));
+    if (c != NULL) {
+        c->numnodes = n;
+        c->numedges = m;
+        c->offsets = malloc((n + 1) * sizeof(int));
+        c->targets = malloc((m > 0 ? m : 1) * sizeof(int));
+        c->weights = malloc((m > 0 ? m : 1) * sizeof(int));
+    }
+    if (c == NULL || *middle == NULL || c->offsets == NULL || c->targets == NULL ||
+        c->weights == NULL || !read_ints(f, c->offsets, n + 1) ||
+        !read_ints(f, c->targets, m) || !read_ints(f, c->weights, m) ||
+        !read_ints(f, *middle, m)) {
+        destroy_csr(c);
+        free(*middle);
+        *middle = NULL;
+        return NULL;
+    }
+    return c;
+}
+
+// Every rank used exactly once
+static bool valid_ranks(const int *rank, int n) {
+    bool *used = calloc(n > 0 ? n : 1, sizeof(bool));
+    bool ok = used != NULL;
+    for (int v = 0; ok && v < n; v++) {
+        ok = rank[v] >= 0 && rank[v] < n && !used[rank[v]];
+        if (ok) {
+            used[rank[v]] = true;
+        }
+    }
+    free(used);
+    return ok;
+}
+
+// The invariants ch_query and unpack_arc rely on: offsets run from 0 to
+// numedges without decreasing, each row lists higher-ranked targets in
+// sorted order with non-negative weights, and a shortcut's middle node
+// ranks below the row's node, so unpacking always terminates.
+static bool valid_arcs(csr_graph *c, const int *middle, const int *rank) {
+    int n = c->numnodes;
+    if (c->offsets[0] != 0 || c->offsets[n] != c->numedges) {
+        return false;
+    }
+    for (int u = 0; u < n; u++) {
+        if (c->offsets[u] > c->offsets[u + 1]) {
+            return false;
+        }
+    }
+    for (int u = 0; u < n; u++) {
+        for (int k = c->offsets[u]; k < c->offsets[u + 1]; k++) {
+            int v = c->targets[k], m = middle[k];
+            if (v < 0 || v >= n || rank[v] <= rank[u] || c->weights[k] < 0 ||
+                (k > c->offsets[u] && c->targets[k - 1] > v) ||
+                m < -1 || m >= n || (m >= 0 && rank[m] >= rank[u])) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Load an index written by save_ch. Returns NULL if the file is missing,
+// truncated or not an index, including one whose arrays would send a query
+// out of bounds.
+ch_index *load_ch(const char *filename) {
+    FILE *f = fopen(filename, "rb");
+    if (f == NULL) {
+        return NULL;
+    }
+    int header[5];
+    ch_index *ch = NULL;
+    if (read_ints(f, header, 5) && header[0] == CH_MAGIC && header[1] == CH_VERSION &&
+        header[2] >= 0 && header[3] >= 0 && header[4] >= 0) {
+        ch = alloc_ch(header[2]);
+    }
+    if (ch != NULL) {
+        bool ok = read_ints(f, ch->rank, ch->numnodes) && valid_ranks(ch->rank, ch->numnodes);
+        ch->up = ok ? read_csr(f, ch->numnodes, header[3], &ch->up_middle) : NULL;
+        ch->down = ch->up ? read_csr(f, ch->numnodes, header[4], &ch->down_middle) : NULL;
+        if (ch->down == NULL || !valid_arcs(ch->up, ch->up_middle, ch->rank) ||
+            !valid_arcs(ch->down, ch->down_middle, ch->rank)) {
+            destroy_ch(ch);
+            ch = NULL;
+        }
+    }
+    fclose(f);
+    return ch;
+}
+
+// ----------------- Queries -----------------
+
+// Per-thread query state. Only nodes a query touched are reset by the next
+// one, so a query costs nothing proportional to the graph size.
+ch_workspace *create_ch_workspace(ch_index *ch) {
+    assert(ch != NULL);
+    int n = ch->numnodes;
+    ch_workspace *ws = calloc(1, sizeof(*ws));
+    if (ws == NULL) {
+        return NULL;
+    }
+    ws->numnodes = n;
+    bool ok = true;
+    for (int d = 0; d < 2; d++) {
+        ws->dist[d] = malloc((n > 0 ? n : 1) * sizeof(int));
+        ws->parent[d] = malloc((n > 0 ? n : 1) * sizeof(int));
+        ws->queue[d] = create_min_heap(n);
+        ok = ok && ws->dist[d] && ws->parent[d] && ws->queue[d];
+    }
+    ws->touched = malloc((n > 0 ? n : 1) * sizeof(int));
+    if (!ok || ws->touched == NULL) {
+        destroy_ch_workspace(ws);
+        return NULL;
+    }
+    for (int v = 0; v < n; v++) {
+        ws->dist[0][v] = ws->dist[1][v] = INF;
+    }
+    return ws;
+}
+
+void destroy_ch_workspace(ch_workspace *ws) {
+    if (ws != NULL) {
+        for (int d = 0; d < 2; d++) {
+            free(ws->dist[d]);
+            free(ws->parent[d]);
+            destroy_min_heap(ws->queue[d]);
+        }
+        free(ws->touched);
+        free(ws);
+    }
+}
+
+// Bypassed node of the hierarchy arc a->b, -1 for an original edge
+static int arc_middle(ch_index *ch, int a, int b) {
+    csr_graph *c = ch->up;
+    int *middle = ch->up_middle;
+    int row = a, target = b;
+    if (ch->rank[a] > ch->rank[b]) {
+        c = ch->down;
+        middle = ch->down_middle;
+        row = b;
+        target = a;
+    }
+    int lo = c->offsets[row], hi = c->offsets[row + 1] - 1;
+    while (lo <= hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (c->targets[mid] == target) {
+            return middle[mid];
+        }
+        if (c->targets[mid] < target) {
+            lo = mid + 1;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    return -1;
+}
+
+// Expand a->b into original edges, recording each as a predecessor link
+static void unpack_arc(ch_index *ch, int a, int b, int *predecessors) {
+    int m = arc_middle(ch, a, b);
+    if (m < 0) {
+        predecessors[b] = a;
+        return;
+    }
+    unpack_arc(ch, a, m, predecessors);
+    unpack_arc(ch, m, b, predecessors);
+}
+
+static void touch(ch_workspace *ws, int v) {
+    if (ws->dist[0][v] == INF && ws->dist[1][v] == INF) {
+        ws->touched[ws->numtouched++] = v;
+    }
+}
+
+// Distance from 'start' to 'end' (INF when unreachable) by bidirectional
+// upward search with stall-on-demand. If 'predecessors' is given, the
+// shortest path is unpacked into it as shortest_path_dijkstra would leave
+// it for print_path; only entries on the path are written.
+int ch_query(ch_index *ch, ch_workspace *ws, int start, int end, int *predecessors) {
+    assert(ch != NULL && ws != NULL);
+    assert(start >= 0 && start < ch->numnodes && end >= 0 && end < ch->numnodes);
+    for (int i = 0; i < ws->numtouched; i++) {
+        int v = ws->touched[i];
+        ws->dist[0][v] = ws->dist[1][v] = INF;
+    }
+    ws->numtouched = 0;
+
+    int ends[2] = { start, end };
+    for (int d = 0; d < 2; d++) {
+        heap_clear(ws->queue[d]);
+        touch(ws, ends[d]);
+        ws->dist[d][ends[d]] = 0;
+        ws->parent[d][ends[d]] = -1;
+        heap_push(ws->queue[d], ends[d], 0);
+    }
+
+    int best = INF, meet = -1;
+    while (ws->queue[0]->size > 0 || ws->queue[1]->size > 0) {
+        for (int d = 0; d < 2; d++) {
+            min_heap *q = ws->queue[d];
+            if (q->size == 0) {
+                continue;
+            }
+            if (q->keys[q->nodes[0]] >= best) {
+                heap_clear(q);      // nothing left here can improve the path
+                continue;
+            }
+            int u = heap_pop(q);
+            int du = ws->dist[d][u];
+            int *dist = ws->dist[d];
+            if (ws->dist[1 - d][u] != INF && du + ws->dist[1 - d][u] < best) {
+                best = du + ws->dist[1 - d][u];
+                meet = u;
+            }
+
+            // Stall u if a higher node already reaches it more cheaply
+            csr_graph *search = d == 0 ? ch->up : ch->down;
+            csr_graph *reverse = d == 0 ? ch->down : ch->up;
+            bool stalled = false;
+            for (int k = reverse->offsets[u]; k < reverse->offsets[u + 1]; k++) {
+                int x = reverse->targets[k];
+                if (dist[x] != INF && dist[x] + reverse->weights[k] < du) {
+                    stalled = true;
+                    break;
+                }
+            }
+            if (stalled) {
+                continue;
+            }
+
+            for (int k = search->offsets[u]; k < search->offsets[u + 1]; k++) {
+                int v = search->targets[k];
+                int alt = du + search->weights[k];
+                if (alt < dist[v]) {
+                    touch(ws, v);
+                    dist[v] = alt;
+                    ws->parent[d][v] = u;
+                    heap_push(q, v, alt);
+                }
+            }
+        }
+    }
+
+    if (predecessors != NULL) {
+        predecessors[start] = -1;
+        if (best == INF) {
+            if (end != start) {
+                predecessors[end] = -1;
+            }
+        } else {
+            for (int v = meet; ws->parent[0][v] != -1; v = ws->parent[0][v]) {
+                unpack_arc(ch, ws->parent[0][v], v, predecessors);
+            }
+            for (int v = meet; ws->parent[1][v] != -1; v = ws->parent[1][v]) {
+                unpack_arc(ch, v, ws->parent[1][v], predecessors);
+            }
+        }
+    }
+    return best;
+}
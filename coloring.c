@@ -0,0 +1,430 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include "header.h"
+
+// Degeneracy (smallest-last) order: repeatedly peel a minimum-degree node
+// from degree buckets and color in reverse peeling order, which needs at
+// most degeneracy + 1 colors. core[v] receives v's core number. 'head'
+// has maxdeg + 1 buckets: parallel arcs and self-loops count toward degree.
+static void smallest_last_order(csr_graph *c, int maxdeg, int *order, int *core, int *degree,
+                                int *head, int *next, int *prev) {
+    int n = c->numnodes;
+    for (int d = 0; d <= maxdeg; d++) {
+        head[d] = -1;
+    }
+    for (int v = 0; v < n; v++) {
+        degree[v] = c->offsets[v + 1] - c->offsets[v];
+        prev[v] = -1;
+        next[v] = head[degree[v]];
+        if (next[v] >= 0) {
+            prev[next[v]] = v;
+        }
+        head[degree[v]] = v;
+    }
+
+    int low = 0, level = 0;
+    for (int i = n - 1; i >= 0; i--) {
+        while (head[low] < 0) {
+            low++;
+        }
+        int v = head[low];
+        head[low] = next[v];
+        if (next[v] >= 0) {
+            prev[next[v]] = -1;
+        }
+        if (low > level) {
+            level = low;
+        }
+        core[v] = level;
+        degree[v] = -1;         // peeled
+        order[i] = v;
+
+        for (int k = c->offsets[v]; k < c->offsets[v + 1]; k++) {
+            int u = c->targets[k];
+            if (degree[u] < 0) {
+                continue;
+            }
+            // Move u down one bucket
+            if (prev[u] >= 0) {
+                next[prev[u]] = next[u];
+            } else {
+                head[degree[u]] = next[u];
+            }
+            if (next[u] >= 0) {
+                prev[next[u]] = prev[u];
+            }
+            degree[u]--;
+            prev[u] = -1;
+            next[u] = head[degree[u]];
+            if (next[u] >= 0) {
+                prev[next[u]] = u;
+            }
+            head[degree[u]] = u;
+            if (degree[u] < low) {
+                low = degree[u];    // parallel arcs drop it by more than one
+            }
+        }
+    }
+}
+
+// Stable counting sort of order[] by descending key[v]; 'out' is scratch
+static bool sort_by_key(int *order, int n, const int *key, int *out) {
+    int maxkey = 0;
+    for (int v = 0; v < n; v++) {
+        if (key[v] > maxkey) {
+            maxkey = key[v];
+        }
+    }
+    int *start = calloc(maxkey + 2, sizeof(int));
+    if (start == NULL) {
+        return false;
+    }
+    for (int v = 0; v < n; v++) {
+        start[maxkey - key[v] + 1]++;
+    }
+    for (int k = 0; k <= maxkey; k++) {
+        start[k + 1] += start[k];
+    }
+    for (int i = 0; i < n; i++) {
+        out[start[maxkey - key[order[i]]]++] = order[i];
+    }
+    for (int i = 0; i < n; i++) {
+        order[i] = out[i];
+    }
+    free(start);
+    return true;
+}
+
+// Fill order[] with the nodes in coloring order; rank[] is its inverse and
+// doubles as the priority (lower rank wins) for the parallel methods. The
+// exact smallest-last order is a chain of dependencies that would
+// serialize Jones-Plassmann, so parallel methods sort by core number
+// instead and break ties randomly.
+static bool make_order(csr_graph *c, int maxdeg, coloring_order ordering, bool parallel,
+                       unsigned long long seed, int *order, int *rank) {
+    int n = c->numnodes;
+    for (int v = 0; v < n; v++) {
+        order[v] = v;
+    }
+    if (ordering != ORDER_NATURAL && (ordering != ORDER_SMALLEST_LAST || parallel)) {
+        // Random tie-breaking keeps equal-key runs from forming long
+        // dependency chains in Jones-Plassmann
+        unsigned long long state = seed ? seed : 1;
+        for (int i = n - 1; i > 0; i--) {
+            int j = next_random(&state) % (i + 1);
+            int t = order[i];
+            order[i] = order[j];
+            order[j] = t;
+        }
+    }
+
+    bool ok = true;
+    if (ordering == ORDER_LARGEST_FIRST) {
+        for (int v = 0; v < n; v++) {
+            rank[v] = c->offsets[v + 1] - c->offsets[v];
+        }
+        int *out = malloc((n > 0 ? n : 1) * sizeof(int));
+        ok = out && sort_by_key(order, n, rank, out);
+        free(out);
+    } else if (ordering == ORDER_SMALLEST_LAST) {
+        int *scratch = malloc((4 * (size_t)n + maxdeg + 1) * sizeof(int));
+        ok = scratch != NULL;
+        if (ok && parallel) {
+            smallest_last_order(c, maxdeg, scratch, rank, scratch + n, scratch + 4 * n,
+                                scratch + 2 * n, scratch + 3 * n);
+            ok = sort_by_key(order, n, rank, scratch);
+        } else if (ok) {
+            smallest_last_order(c, maxdeg, order, rank, scratch, scratch + 3 * n, scratch + n,
+                                scratch + 2 * n);
+        }
+        free(scratch);
+    }
+    if (!ok) {
+        return false;
+    }
+
+    for (int i = 0; i < n; i++) {
+        rank[order[i]] = i;
+    }
+    return true;
+}
+
+// Smallest color not used by v's neighbors. 'mark' holds maxdeg + 1 stamps
+// and is never cleared: a color is taken when its stamp equals v.
+static int first_fit(csr_graph *c, const int *color, int v, int *mark) {
+    int d = c->offsets[v + 1] - c->offsets[v];
+    for (int k = c->offsets[v]; k < c->offsets[v + 1]; k++) {
+        int col = __atomic_load_n(&color[c->targets[k]], __ATOMIC_RELAXED);
+        if (col >= 0 && col <= d) {
+            mark[col] = v;
+        }
+    }
+    int col = 0;
+    while (mark[col] == v) {
+        col++;
+    }
+    return col;
+}
+
+static bool greedy_color(csr_graph *c, const int *order, int *color, int maxdeg) {
+    int *mark = malloc((maxdeg + 1) * sizeof(int));
+    if (mark == NULL) {
+        return false;
+    }
+    for (int i = 0; i <= maxdeg; i++) {
+        mark[i] = -1;
+    }
+    for (int i = 0; i < c->numnodes; i++) {
+        int v = order[i];
+        color[v] = first_fit(c, color, v, mark);
+    }
+    free(mark);
+    return true;
+}
+
+typedef struct {
+    csr_graph *c;
+    const int *work;
+    const int *rank;
+    int *color;
+    int *mark;          // maxdeg + 1 stamps per worker
+    int marks;
+    int *out;           // conflicts (speculative) or picks (Jones-Plassmann)
+    int numconflicts;
+} color_job;
+
+// Reset every worker's stamps before a round; stale stamps of a node being
+// recolored would otherwise hide colors from it
+static void clear_marks(color_job *job, int numworkers) {
+    for (int i = 0; i < numworkers * job->marks; i++) {
+        job->mark[i] = -1;
+    }
+}
+
+static void color_speculatively(int begin, int end, int worker, void *arg) {
+    color_job *job = arg;
+    int *mark = job->mark + (size_t)worker * job->marks;
+    for (int i = begin; i < end; i++) {
+        int v = job->work[i];
+        __atomic_store_n(&job->color[v], first_fit(job->c, job->color, v, mark), __ATOMIC_RELAXED);
+    }
+}
+
+// Collect worklist nodes that share a color with an earlier-ranked neighbor
+static void find_conflicts(int begin, int end, int worker, void *arg) {
+    color_job *job = arg;
+    csr_graph *c = job->c;
+    for (int i = begin; i < end; i++) {
+        int v = job->work[i];
+        for (int k = c->offsets[v]; k < c->offsets[v + 1]; k++) {
+            int u = c->targets[k];
+            if (job->color[u] == job->color[v] && job->rank[u] < job->rank[v]) {
+                int slot = __atomic_fetch_add(&job->numconflicts, 1, __ATOMIC_RELAXED);
+                job->out[slot] = v;
+                break;
+            }
+        }
+    }
+}
+
+// Speculative parallel greedy (Gebremedhin-Manne): color the worklist in
+// parallel against whatever the neighbors hold, then find edges whose ends
+// collided and recolor the later-ranked end in the next round. The
+// earliest-ranked node of a conflict keeps its color, so rounds shrink.
+static bool speculative_color(csr_graph *c, const int *order, const int *rank, int *color,
+                              int maxdeg) {
+    int n = c->numnodes;
+    int numworkers = scheduler_acquire();
+    int *work = malloc((n > 0 ? n : 1) * sizeof(int));
+    int *conflicts = malloc((n > 0 ? n : 1) * sizeof(int));
+    int *mark = malloc((size_t)numworkers * (maxdeg + 1) * sizeof(int));
+    if (work == NULL || conflicts == NULL || mark == NULL) {
+        free(work);
+        free(conflicts);
+        free(mark);
+        scheduler_release();
+        return false;
+    }
+    for (int i = 0; i < n; i++) {
+        work[i] = order[i];
+    }
+
+    color_job job = {c, work, rank, color, mark, maxdeg + 1, conflicts, 0};
+    int count = n;
+    while (count > 0) {
+        job.work = work;
+        job.out = conflicts;
+        clear_marks(&job, numworkers);
+        parallel_for(0, count, 256, color_speculatively, &job);
+
+        job.numconflicts = 0;
+        parallel_for(0, count, 256, find_conflicts, &job);
+
+        int *t = work;
+        work = conflicts;
+        conflicts = t;
+        count = job.numconflicts;
+    }
+    free(work);
+    free(conflicts);
+    free(mark);
+    scheduler_release();
+    return true;
+}
+
+// pick[i] = first-fit color of work[i] when it outranks all its uncolored
+// neighbors, else -1
+static void pick_local_maxima(int begin, int end, int worker, void *arg) {
+    color_job *job = arg;
+    csr_graph *c = job->c;
+    int *mark = job->mark + (size_t)worker * job->marks;
+    for (int i = begin; i < end; i++) {
+        int v = job->work[i];
+        job->out[i] = -1;
+        bool local_max = true;
+        for (int k = c->offsets[v]; k < c->offsets[v + 1]; k++) {
+            int u = c->targets[k];
+            if (job->color[u] < 0 && job->rank[u] < job->rank[v]) {
+                local_max = false;
+                break;
+            }
+        }
+        if (local_max) {
+            job->out[i] = first_fit(c, job->color, v, mark);
+        }
+    }
+}
+
+// Jones-Plassmann: each round colors, in parallel, every uncolored node
+// that outranks all its uncolored neighbors. Those nodes form an
+// independent set, so no conflicts arise and the result equals a greedy
+// coloring in some order consistent with the priorities.
+static bool jones_plassmann_color(csr_graph *c, const int *rank, int *color, int maxdeg) {
+    int n = c->numnodes;
+    int numworkers = scheduler_acquire();
+    int *work = malloc((n > 0 ? n : 1) * sizeof(int));
+    int *pick = malloc((n > 0 ? n : 1) * sizeof(int));
+    int *mark = malloc((size_t)numworkers * (maxdeg + 1) * sizeof(int));
+    if (work == NULL || pick == NULL || mark == NULL) {
+        free(work);
+        free(pick);
+        free(mark);
+        scheduler_release();
+        return false;
+    }
+    for (int v = 0; v < n; v++) {
+        work[v] = v;
+    }
+
+    color_job job = {c, work, rank, color, mark, maxdeg + 1, pick, 0};
+    int count = n;
+    while (count > 0) {
+        clear_marks(&job, numworkers);
+        parallel_for(0, count, 256, pick_local_maxima, &job);
+
+        // Publish this round's colors only after every decision is made
+        int remaining = 0;
+        for (int i = 0; i < count; i++) {
+            if (pick[i] >= 0) {
+                color[work[i]] = pick[i];
+            } else {
+                work[remaining++] = work[i];
+            }
+        }
+        count = remaining;
+    }
+    free(work);
+    free(pick);
+    free(mark);
+    scheduler_release();
+    return true;
+}
+
+// Proper vertex coloring of an undirected CSR; colors are 0 .. numcolors-1
+// and adjacent nodes never share one. 'seed' drives the random orderings.
+coloring_result *color_graph_csr(csr_graph *undirected, coloring_method method,
+                                 coloring_order ordering, unsigned long long seed) {
+    assert(undirected != NULL);
+    int n = undirected->numnodes;
+    coloring_result *r = malloc(sizeof(*r));
+    int *order = malloc((n > 0 ? n : 1) * sizeof(int));
+    int *rank = malloc((n > 0 ? n : 1) * sizeof(int));
+    int *color = malloc((n > 0 ? n : 1) * sizeof(int));
+    bool ok = r && order && rank && color;
+    int maxdeg = 0;
+    for (int v = 0; v < n; v++) {
+        int d = undirected->offsets[v + 1] - undirected->offsets[v];
+        if (d > maxdeg) {
+            maxdeg = d;
+        }
+    }
+    ok = ok && make_order(undirected, maxdeg, ordering, method != COLOR_GREEDY, seed, order, rank);
+
+    if (ok) {
+        for (int v = 0; v < n; v++) {
+            color[v] = -1;
+        }
+        switch (method) {
+            case COLOR_GREEDY:
+                ok = greedy_color(undirected, order, color, maxdeg);
+                break;
+            case COLOR_SPECULATIVE:
+                ok = speculative_color(undirected, order, rank, color, maxdeg);
+                break;
+            case COLOR_JONES_PLASSMANN:
+                ok = jones_plassmann_color(undirected, rank, color, maxdeg);
+                break;
+        }
+    }
+    free(order);
+    free(rank);
+    if (!ok) {
+        printf("Memory allocation failed\n");
+        free(color);
+        free(r);
+        return NULL;
+    }
+
+    r->numnodes = n;
+    r->color = color;
+    r->numcolors = 0;
+    for (int v = 0; v < n; v++) {
+        if (color[v] + 1 > r->numcolors) {
+            r->numcolors = color[v] + 1;
+        }
+    }
+    return r;
+}
+
+// Nodes joined by an edge in either direction get different colors
+coloring_result *color_graph(graph *g, coloring_method method, coloring_order ordering,
+                             unsigned long long seed) {
+    assert(g != NULL);
+    csr_graph *c = build_csr_undirected(g);
+    if (c == NULL) {
+        printf("Memory allocation failed\n");
+        return NULL;
+    }
+    coloring_result *r = color_graph_csr(c, method, ordering, seed);
+    destroy_csr(c);
+    return r;
+}
+
+bool is_valid_coloring(csr_graph *undirected, const int *color) {
+    for (int v = 0; v < undirected->numnodes; v++) {
+        for (int k = undirected->offsets[v]; k < undirected->offsets[v + 1]; k++) {
+            if (undirected->targets[k] != v && color[undirected->targets[k]] == color[v]) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void destroy_coloring_result(coloring_result *r) {
+    if (r != NULL) {
+        free(r->color);
+        free(r);
+    }
+}
@@ -0,0 +1,556 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "header.h"
+
+// Louvain stops refining a level once a sweep gains less than this
+#define MIN_MODULARITY_GAIN 1e-7
+
+// Symmetric weighted graph used between Louvain levels. Entry (u, v) with
+// u != v appears in both rows; a self-loop holds the total weight of the
+// entries folded into u and appears once.
+typedef struct {
+    int numnodes;
+    int *offsets;
+    int *targets;
+    double *weights;
+} weighted_graph;
+
+static void destroy_weighted(weighted_graph *w) {
+    if (w != NULL) {
+        free(w->offsets);
+        free(w->targets);
+        free(w->weights);
+        free(w);
+    }
+}
+
+static weighted_graph *alloc_weighted(int numnodes, int numentries) {
+    weighted_graph *w = malloc(sizeof(*w));
+    if (w == NULL) {
+        return NULL;
+    }
+    w->numnodes = numnodes;
+    w->offsets = malloc((numnodes + 1) * sizeof(int));
+    w->targets = malloc((numentries > 0 ? numentries : 1) * sizeof(int));
+    w->weights = malloc((numentries > 0 ? numentries : 1) * sizeof(double));
+    if (w->offsets == NULL || w->targets == NULL || w->weights == NULL) {
+        destroy_weighted(w);
+        return NULL;
+    }
+    return w;
+}
+
+void destroy_community_result(community_result *r) {
+    if (r != NULL) {
+        free(r->community);
+        free(r);
+    }
+}
+
+static community_result *alloc_result(int numnodes) {
+    community_result *r = malloc(sizeof(*r));
+    if (r == NULL) {
+        return NULL;
+    }
+    r->numnodes = numnodes;
+    r->numcommunities = 0;
+    r->modularity = 0.0;
+    r->community = malloc((numnodes > 0 ? numnodes : 1) * sizeof(int));
+    if (r->community == NULL) {
+        free(r);
+        return NULL;
+    }
+    return r;
+}
+
+// Relabel communities to 0 .. k-1 in order of first appearance; returns k
+static int compact_labels(int *label, int n) {
+    int *map = malloc((n > 0 ? n : 1) * sizeof(int));
+    if (map == NULL) {
+        return -1;
+    }
+    for (int i = 0; i < n; i++) {
+        map[i] = -1;
+    }
+    int k = 0;
+    for (int i = 0; i < n; i++) {
+        if (map[label[i]] < 0) {
+            map[label[i]] = k++;
+        }
+        label[i] = map[label[i]];
+    }
+    free(map);
+    return k;
+}
+
+// Newman modularity of a partition of the undirected view (unit weights)
+double modularity(csr_graph *undirected, const int *community) {
+    assert(undirected != NULL && community != NULL);
+    int n = undirected->numnodes;
+    double m2 = undirected->numedges;
+    if (m2 == 0) {
+        return 0.0;
+    }
+
+    double *total = calloc(n > 0 ? n : 1, sizeof(double));
+    if (total == NULL) {
+        printf("Memory allocation failed\n");
+        return 0.0;
+    }
+    double inside = 0.0;
+    for (int u = 0; u < n; u++) {
+        total[community[u]] += undirected->offsets[u + 1] - undirected->offsets[u];
+        for (int k = undirected->offsets[u]; k < undirected->offsets[u + 1]; k++) {
+            if (community[undirected->targets[k]] == community[u]) {
+                inside += 1.0;
+            }
+        }
+    }
+    double q = inside / m2;
+    for (int c = 0; c < n; c++) {
+        q -= (total[c] / m2) * (total[c] / m2);
+    }
+    free(total);
+    return q;
+}
+
+// Root of v's tree in the union-find forest. Parents only ever decrease,
+// so a stale read just takes a longer path to the same root.
+static int find_root(int *parent, int v) {
+    int p = __atomic_load_n(&parent[v], __ATOMIC_RELAXED);
+    while (p != v) {
+        v = p;
+        p = __atomic_load_n(&parent[v], __ATOMIC_RELAXED);
+    }
+    return v;
+}
+
+typedef struct {
+    csr_graph *undirected;
+    int *parent;
+} components_job;
+
+// Union the ends of every edge out of [begin, end): the larger root is hooked
+// under the smaller with a compare-and-swap, retried if another worker moved
+// that root first
+static void hook_edges(int begin, int end, int worker, void *arg) {
+    components_job *job = arg;
+    csr_graph *undirected = job->undirected;
+    for (int u = begin; u < end; u++) {
+        for (int k = undirected->offsets[u]; k < undirected->offsets[u + 1]; k++) {
+            int v = undirected->targets[k];
+            for (;;) {
+                int ru = find_root(job->parent, u), rv = find_root(job->parent, v);
+                if (ru == rv) {
+                    break;
+                }
+                int hi = ru > rv ? ru : rv, lo = ru > rv ? rv : ru;
+                if (__atomic_compare_exchange_n(&job->parent[hi], &hi, lo, false,
+                                                __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                    break;
+                }
+            }
+        }
+    }
+}
+
+static void flatten_roots(int begin, int end, int worker, void *arg) {
+    components_job *job = arg;
+    for (int v = begin; v < end; v++) {
+        __atomic_store_n(&job->parent[v], find_root(job->parent, v), __ATOMIC_RELAXED);
+    }
+}
+
+// Connected components of an undirected CSR by parallel lock-free
+// union-find. Roots are always the smallest id of their tree, so
+// 'component' gets the smallest node id of each component as in
+// compressed_connected_components. Returns the number of components.
+int connected_components_csr(csr_graph *undirected, int *component) {
+    assert(undirected != NULL && component != NULL);
+    int n = undirected->numnodes;
+    for (int v = 0; v < n; v++) {
+        component[v] = v;
+    }
+    components_job job = {undirected, component};
+    parallel_for(0, n, 0, hook_edges, &job);
+    parallel_for(0, n, 0, flatten_roots, &job);
+
+    int count = 0;
+    for (int v = 0; v < n; v++) {
+        count += component[v] == v;
+    }
+    return count;
+}
+
+typedef struct {
+    csr_graph *undirected;
+    const int *order;
+    int *label;         // read and written by all workers at once
+    int slots;          // hash slots per worker, a power of two > 2 * max degree
+    int *keys;          // label held by each slot, -1 when free
+    int *count;
+    int *seen;          // slots filled for the current node, in order
+} propagation_job;
+
+// Slot of label 'l' in a worker's table, claiming a free one if absent
+static int label_slot(const propagation_job *job, int *keys, int l) {
+    int mask = job->slots - 1;
+    int slot = (int)((unsigned)l * 2654435761u & (unsigned)mask);
+    while (keys[slot] != l && keys[slot] != -1) {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+// Move each node in order[begin .. end) to its neighbors' most frequent
+// label; accumulates the number of nodes that changed
+static void relabel_nodes(int begin, int end, int worker, void *accumulator, void *arg) {
+    propagation_job *job = arg;
+    csr_graph *undirected = job->undirected;
+    int *label = job->label;
+    int *keys = job->keys + (size_t)worker * job->slots;
+    int *count = job->count + (size_t)worker * job->slots;
+    int *seen = job->seen + (size_t)worker * job->slots;
+    long long changes = 0;
+    for (int i = begin; i < end; i++) {
+        int v = job->order[i];
+        int first = undirected->offsets[v], last = undirected->offsets[v + 1];
+        if (first == last) {
+            continue;
+        }
+
+        int numseen = 0;
+        for (int k = first; k < last; k++) {
+            int l = __atomic_load_n(&label[undirected->targets[k]], __ATOMIC_RELAXED);
+            int slot = label_slot(job, keys, l);
+            if (keys[slot] == -1) {
+                keys[slot] = l;
+                seen[numseen++] = slot;
+            }
+            count[slot]++;
+        }
+        int current = label[v];
+        int here = label_slot(job, keys, current);
+        int best = current, bestcount = keys[here] == current ? count[here] : 0;
+        for (int s = 0; s < numseen; s++) {
+            int l = keys[seen[s]], c = count[seen[s]];
+            if (c > bestcount || (c == bestcount && best != current && l < best)) {
+                best = l;
+                bestcount = c;
+            }
+        }
+        for (int s = 0; s < numseen; s++) {
+            keys[seen[s]] = -1;
+            count[seen[s]] = 0;
+        }
+        if (best != current) {
+            __atomic_store_n(&label[v], best, __ATOMIC_RELAXED);
+            changes++;
+        }
+    }
+    *(long long *)accumulator += changes;
+}
+
+// Parallel label propagation: every node repeatedly adopts the most common
+// label among its neighbors (ties keep the current label, else the smallest)
+// until no label changes or 'max_iterations' sweeps have run.
+community_result *label_propagation_csr(csr_graph *undirected, int max_iterations, unsigned long long seed) {
+    assert(undirected != NULL);
+    int n = undirected->numnodes;
+    community_result *r = alloc_result(n);
+    int *order = malloc((n > 0 ? n : 1) * sizeof(int));
+    if (r == NULL || order == NULL) {
+        printf("Memory allocation failed\n");
+        destroy_community_result(r);
+        free(order);
+        return NULL;
+    }
+    int *label = r->community;
+    for (int v = 0; v < n; v++) {
+        label[v] = v;
+        order[v] = v;
+    }
+
+    // Per-worker label tallies: a hash table with room for any node's
+    // neighborhood, emptied again through seen[] after each node
+    int maxdeg = 0;
+    for (int v = 0; v < n; v++) {
+        int degree = undirected->offsets[v + 1] - undirected->offsets[v];
+        maxdeg = degree > maxdeg ? degree : maxdeg;
+    }
+    int slots = 2;
+    while (slots <= 2 * maxdeg) {
+        slots *= 2;
+    }
+    int numworkers = scheduler_acquire();
+    int *keys = malloc((size_t)numworkers * slots * sizeof(int));
+    int *count = calloc((size_t)numworkers * slots, sizeof(int));
+    int *seen = malloc((size_t)numworkers * slots * sizeof(int));
+    for (size_t i = 0; keys != NULL && i < (size_t)numworkers * slots; i++) {
+        keys[i] = -1;
+    }
+    propagation_job job = {undirected, order, label, slots, keys, count, seen};
+
+    unsigned long long state = seed ? seed : 1;
+    bool failed = keys == NULL || count == NULL || seen == NULL;
+    for (int iter = 0; !failed && iter < max_iterations; iter++) {
+        // A fresh random order each sweep avoids label oscillation
+        for (int i = n - 1; i > 0; i--) {
+            int j = next_random(&state) % (i + 1);
+            int t = order[i];
+            order[i] = order[j];
+            order[j] = t;
+        }
+
+        long long changes = 0;
+        if (!parallel_reduce(0, n, 1024, &changes, sizeof(long long), relabel_nodes,
+                             reduce_sum_long, &job)) {
+            failed = true;
+            break;
+        }
+        if (changes == 0) {
+            break;
+        }
+    }
+    free(order);
+    free(keys);
+    free(count);
+    free(seen);
+    scheduler_release();
+    if (failed) {
+        printf("Memory allocation failed\n");
+        destroy_community_result(r);
+        return NULL;
+    }
+
+    r->numcommunities = compact_labels(label, n);
+    r->modularity = modularity(undirected, label);
+    return r;
+}
+
+// One Louvain level: greedily move single nodes to the neighboring community
+// with the best modularity gain until a sweep no longer improves. 'comm' gets
+// the community of every node of 'w'. Returns true if any node moved.
+static bool louvain_move_nodes(weighted_graph *w, double m2, int *comm) {
+    int n = w->numnodes;
+    double *degree = calloc(n, sizeof(double));
+    double *total = calloc(n, sizeof(double));
+    double *link = calloc(n, sizeof(double));
+    int *seen = malloc(n * sizeof(int));
+    if (!degree || !total || !link || !seen) {
+        free(degree);
+        free(total);
+        free(link);
+        free(seen);
+        return false;
+    }
+
+    for (int u = 0; u < n; u++) {
+        comm[u] = u;
+        for (int k = w->offsets[u]; k < w->offsets[u + 1]; k++) {
+            degree[u] += w->weights[k];
+        }
+        total[u] = degree[u];
+    }
+
+    bool moved_any = false;
+    double gain;
+    do {
+        gain = 0.0;
+        for (int u = 0; u < n; u++) {
+            int own = comm[u];
+            int numseen = 0;
+            // Weight from u into each neighboring community
+            for (int k = w->offsets[u]; k < w->offsets[u + 1]; k++) {
+                int v = w->targets[k];
+                if (v == u) {
+                    continue;
+                }
+                int c = comm[v];
+                if (link[c] == 0.0) {
+                    seen[numseen++] = c;
+                }
+                link[c] += w->weights[k];
+            }
+
+            total[own] -= degree[u];
+            int best = own;
+            double owngain = link[own] - total[own] * degree[u] / m2;
+            double bestgain = owngain;
+            for (int s = 0; s < numseen; s++) {
+                int c = seen[s];
+                double g = link[c] - total[c] * degree[u] / m2;
+                if (g > bestgain) {
+                    bestgain = g;
+                    best = c;
+                }
+            }
+            total[best] += degree[u];
+            if (best != own) {
+                comm[u] = best;
+                gain += (bestgain - owngain) / m2;
+                moved_any = true;
+            }
+
+            for (int s = 0; s < numseen; s++) {
+                link[seen[s]] = 0.0;
+            }
+            link[own] = 0.0;
+        }
+    } while (gain > MIN_MODULARITY_GAIN);
+
+    free(degree);
+    free(total);
+    free(link);
+    free(seen);
+    return moved_any;
+}
+
+// Collapse each community into one node, summing the weights between them
+static weighted_graph *louvain_aggregate(weighted_graph *w, const int *comm, int k) {
+    int n = w->numnodes;
+    int *members = malloc((n > 0 ? n : 1) * sizeof(int));
+    int *start = calloc(k + 1, sizeof(int));
+    double *link = calloc(k > 0 ? k : 1, sizeof(double));
+    int *seen = malloc((k > 0 ? k : 1) * sizeof(int));
+    bool *is_seen = calloc(k > 0 ? k : 1, sizeof(bool));
+    weighted_graph *agg = NULL;
+    if (!members || !start || !link || !seen || !is_seen) {
+        goto done;
+    }
+
+    // Bucket nodes by community
+    for (int u = 0; u < n; u++) {
+        start[comm[u] + 1]++;
+    }
+    for (int c = 0; c < k; c++) {
+        start[c + 1] += start[c];
+    }
+    int *fill = malloc((k > 0 ? k : 1) * sizeof(int));
+    if (fill == NULL) {
+        goto done;
+    }
+    memcpy(fill, start, k * sizeof(int));
+    for (int u = 0; u < n; u++) {
+        members[fill[comm[u]]++] = u;
+    }
+    free(fill);
+
+    // Entries in the aggregate never exceed those of the finer graph
+    agg = alloc_weighted(k, w->offsets[n]);
+    if (agg == NULL) {
+        goto done;
+    }
+    int pos = 0;
+    for (int c = 0; c < k; c++) {
+        int numseen = 0;
+        for (int i = start[c]; i < start[c + 1]; i++) {
+            int u = members[i];
+            for (int e = w->offsets[u]; e < w->offsets[u + 1]; e++) {
+                int d = comm[w->targets[e]];
+                if (!is_seen[d]) {
+                    is_seen[d] = true;
+                    seen[numseen++] = d;
+                }
+                link[d] += w->weights[e];
+            }
+        }
+        agg->offsets[c] = pos;
+        for (int s = 0; s < numseen; s++) {
+            int d = seen[s];
+            agg->targets[pos] = d;
+            agg->weights[pos] = link[d];
+            pos++;
+            link[d] = 0.0;
+            is_seen[d] = false;
+        }
+    }
+    agg->offsets[k] = pos;
+
+done:
+    free(members);
+    free(start);
+    free(link);
+    free(seen);
+    free(is_seen);
+    return agg;
+}
+
+// Multi-level Louvain: alternate local moving and aggregation until a level
+// moves nothing or 'max_levels' levels have run
+community_result *louvain_csr(csr_graph *undirected, int max_levels) {
+    assert(undirected != NULL);
+    int n = undirected->numnodes;
+    community_result *r = alloc_result(n);
+    weighted_graph *w = alloc_weighted(n, undirected->numedges);
+    int *comm = malloc((n > 0 ? n : 1) * sizeof(int));
+    if (r == NULL || w == NULL || comm == NULL) {
+        printf("Memory allocation failed\n");
+        destroy_community_result(r);
+        destroy_weighted(w);
+        free(comm);
+        return NULL;
+    }
+
+    memcpy(w->offsets, undirected->offsets, (n + 1) * sizeof(int));
+    memcpy(w->targets, undirected->targets, undirected->numedges * sizeof(int));
+    for (int k = 0; k < undirected->numedges; k++) {
+        w->weights[k] = 1.0;
+    }
+    for (int v = 0; v < n; v++) {
+        r->community[v] = v;
+    }
+
+    double m2 = undirected->numedges;
+    for (int level = 0; level < max_levels && m2 > 0; level++) {
+        if (!louvain_move_nodes(w, m2, comm)) {
+            break;
+        }
+        int k = compact_labels(comm, w->numnodes);
+        if (k < 0) {
+            break;
+        }
+        // Nodes of the current level are the communities of the previous one
+        for (int v = 0; v < n; v++) {
+            r->community[v] = comm[r->community[v]];
+        }
+        weighted_graph *next = louvain_aggregate(w, comm, k);
+        destroy_weighted(w);
+        w = next;
+        if (w == NULL) {
+            break;
+        }
+    }
+    destroy_weighted(w);
+    free(comm);
+
+    r->numcommunities = compact_labels(r->community, n);
+    r->modularity = modularity(undirected, r->community);
+    return r;
+}
+
+community_result *label_propagation(graph *g, int max_iterations, unsigned long long seed) {
+    assert(g != NULL);
+    csr_graph *undirected = build_csr_undirected(g);
+    if (undirected == NULL) {
+        printf("Memory allocation failed\n");
+        return NULL;
+    }
+    community_result *r = label_propagation_csr(undirected, max_iterations, seed);
+    destroy_csr(undirected);
+    return r;
+}
+
+community_result *louvain(graph *g, int max_levels) {
+    assert(g != NULL);
+    csr_graph *undirected = build_csr_undirected(g);
+    if (undirected == NULL) {
+        printf("Memory allocation failed\n");
+        return NULL;
+    }
+    community_result *r = louvain_csr(undirected, max_levels);
+    destroy_csr(undirected);
+    return r;
+}
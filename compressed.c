@@ -0,0 +1,448 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "header.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <tmmintrin.h>
+#define HAVE_SSSE3_DECODER 1
+#endif
+
+// Layout of one neighbor list in 'data':
+//   varint degree
+//   varint zigzag(first neighbor - node)     (only when degree > 0)
+//   degree-1 gaps between consecutive neighbors, as LEB128 varints
+//   (COMPRESS_VARINT) or as Stream VByte: 2-bit length codes for four values
+//   per control byte, followed by the value bytes (COMPRESS_STREAMVBYTE).
+// 'data' carries 16 bytes of padding so SIMD loads never run past the end.
+#define DECODE_PADDING 16
+
+typedef struct {
+    unsigned char *bytes;
+    size_t size;
+    size_t capacity;
+} byte_buffer;
+
+static bool reserve(byte_buffer *b, size_t extra) {
+    if (b->size + extra <= b->capacity) {
+        return true;
+    }
+    size_t capacity = b->capacity ? b->capacity : 1024;
+    while (capacity < b->size + extra) {
+        capacity *= 2;
+    }
+    unsigned char *bytes = realloc(b->bytes, capacity);
+    if (bytes == NULL) {
+        return false;
+    }
+    b->bytes = bytes;
+    b->capacity = capacity;
+    return true;
+}
+
+static void put_varint(byte_buffer *b, unsigned int x) {
+    while (x >= 0x80) {
+        b->bytes[b->size++] = (unsigned char)(x | 0x80);
+        x >>= 7;
+    }
+    b->bytes[b->size++] = (unsigned char)x;
+}
+
+static unsigned int get_varint(const unsigned char **p) {
+    unsigned int x = 0;
+    int shift = 0;
+    unsigned char byte;
+    do {
+        byte = *(*p)++;
+        x |= (unsigned int)(byte & 0x7F) << shift;
+        shift += 7;
+    } while (byte & 0x80);
+    return x;
+}
+
+static unsigned int zigzag(int x) {
+    return ((unsigned int)x << 1) ^ (unsigned int)(x >> 31);
+}
+
+static int unzigzag(unsigned int x) {
+    return (int)(x >> 1) ^ -(int)(x & 1);
+}
+
+static int svb_length(unsigned int x) {
+    return x < (1u << 8) ? 1 : x < (1u << 16) ? 2 : x < (1u << 24) ? 3 : 4;
+}
+
+// Stream VByte for 'count' gaps: control bytes first, then value bytes
+static void put_streamvbyte(byte_buffer *b, const unsigned int *values, int count) {
+    unsigned char *control = b->bytes + b->size;
+    size_t numcontrol = ((size_t)count + 3) / 4;
+    memset(control, 0, numcontrol);
+    b->size += numcontrol;
+    for (int i = 0; i < count; i++) {
+        int len = svb_length(values[i]);
+        control[i / 4] |= (unsigned char)((len - 1) << (2 * (i % 4)));
+        for (int k = 0; k < len; k++) {
+            b->bytes[b->size++] = (unsigned char)(values[i] >> (8 * k));
+        }
+    }
+}
+
+// Scalar Stream VByte decode with running prefix sum
+static const unsigned char *svb_decode_scalar(const unsigned char *control, int count, int prev, int *out) {
+    const unsigned char *data = control + (count + 3) / 4;
+    for (int i = 0; i < count; i++) {
+        int len = ((control[i / 4] >> (2 * (i % 4))) & 3) + 1;
+        unsigned int x = 0;
+        for (int k = 0; k < len; k++) {
+            x |= (unsigned int)data[k] << (8 * k);
+        }
+        data += len;
+        prev += (int)x;
+        out[i] = prev;
+    }
+    return data;
+}
+
+#ifdef HAVE_SSSE3_DECODER
+// pshufb masks and byte lengths for every control byte
+static unsigned char svb_shuffle[256][16];
+static unsigned char svb_lengths[256];
+static int svb_simd_state;   // 0 unknown, 1 available, -1 unavailable
+
+static void svb_init_tables(void) {
+    for (int c = 0; c < 256; c++) {
+        int pos = 0;
+        for (int lane = 0; lane < 4; lane++) {
+            int len = ((c >> (2 * lane)) & 3) + 1;
+            for (int k = 0; k < 4; k++) {
+                svb_shuffle[c][lane * 4 + k] = k < len ? (unsigned char)(pos + k) : 0x80;
+            }
+            pos += len;
+        }
+        svb_lengths[c] = (unsigned char)pos;
+    }
+}
+
+// Four values per control byte: one pshufb widens the packed bytes to
+// 32-bit lanes, two shifted adds turn the gaps into a prefix sum.
+__attribute__((target("ssse3")))
+static const unsigned char *svb_decode_ssse3(const unsigned char *control, int count, int prev, int *out) {
+    const unsigned char *data = control + (count + 3) / 4;
+    __m128i carry = _mm_set1_epi32(prev);
+    int full = count / 4;
+    for (int i = 0; i < full; i++) {
+        unsigned char c = control[i];
+        __m128i packed = _mm_loadu_si128((const __m128i *)data);
+        __m128i v = _mm_shuffle_epi8(packed, _mm_loadu_si128((const __m128i *)svb_shuffle[c]));
+        v = _mm_add_epi32(v, _mm_slli_si128(v, 4));
+        v = _mm_add_epi32(v, _mm_slli_si128(v, 8));
+        v = _mm_add_epi32(v, carry);
+        _mm_storeu_si128((__m128i *)(out + 4 * i), v);
+        carry = _mm_shuffle_epi32(v, _MM_SHUFFLE(3, 3, 3, 3));
+        data += svb_lengths[c];
+    }
+    prev = _mm_cvtsi128_si32(carry);
+
+    // Tail of fewer than four values
+    int rest = count - 4 * full;
+    if (rest > 0) {
+        unsigned char c = control[full];
+        for (int i = 0; i < rest; i++) {
+            int len = ((c >> (2 * i)) & 3) + 1;
+            unsigned int x = 0;
+            for (int k = 0; k < len; k++) {
+                x |= (unsigned int)data[k] << (8 * k);
+            }
+            data += len;
+            prev += (int)x;
+            out[4 * full + i] = prev;
+        }
+    }
+    return data;
+}
+
+static bool svb_simd_available(void) {
+    if (svb_simd_state == 0) {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("ssse3")) {
+            svb_init_tables();
+            svb_simd_state = 1;
+        } else {
+            svb_simd_state = -1;
+        }
+    }
+    return svb_simd_state > 0;
+}
+#endif
+
+// Compress a CSR. Neighbor lists must be sorted ascending (as build_csr does).
+compressed_graph *compress_csr(csr_graph *c, compression_scheme scheme) {
+    assert(c != NULL);
+    int n = c->numnodes;
+    compressed_graph *cg = malloc(sizeof(*cg));
+    size_t *offsets = malloc((n + 1) * sizeof(size_t));
+    unsigned int *gaps = NULL;
+    byte_buffer b = {0};
+
+    int maxdeg = 0;
+    for (int v = 0; v < n; v++) {
+        if (c->offsets[v + 1] - c->offsets[v] > maxdeg) {
+            maxdeg = c->offsets[v + 1] - c->offsets[v];
+        }
+    }
+    gaps = malloc((maxdeg > 0 ? maxdeg : 1) * sizeof(unsigned int));
+    if (cg == NULL || offsets == NULL || gaps == NULL) {
+        goto fail;
+    }
+
+    for (int v = 0; v < n; v++) {
+        const int *nbrs = c->targets + c->offsets[v];
+        int deg = c->offsets[v + 1] - c->offsets[v];
+        // Worst case: 5 bytes per varint, or 1 control + 4 value bytes per gap
+        if (!reserve(&b, 10 + (size_t)deg * 5)) {
+            goto fail;
+        }
+        offsets[v] = b.size;
+        put_varint(&b, deg);
+        if (deg == 0) {
+            continue;
+        }
+        put_varint(&b, zigzag(nbrs[0] - v));
+        for (int i = 1; i < deg; i++) {
+            gaps[i - 1] = (unsigned int)(nbrs[i] - nbrs[i - 1]);
+        }
+        if (scheme == COMPRESS_STREAMVBYTE) {
+            put_streamvbyte(&b, gaps, deg - 1);
+        } else {
+            for (int i = 0; i < deg - 1; i++) {
+                put_varint(&b, gaps[i]);
+            }
+        }
+    }
+#ifdef HAVE_SSSE3_DECODER
+    // Build the decode tables now, while construction is still single-threaded
+    svb_simd_available();
+#endif
+    if (!reserve(&b, DECODE_PADDING)) {
+        goto fail;
+    }
+    offsets[n] = b.size;
+    memset(b.bytes + b.size, 0, DECODE_PADDING);
+
+    // Give back the slack from doubling
+    unsigned char *shrunk = realloc(b.bytes, b.size + DECODE_PADDING);
+    cg->data = shrunk ? shrunk : b.bytes;
+    cg->size = b.size;
+    cg->offsets = offsets;
+    cg->numnodes = n;
+    cg->numedges = c->numedges;
+    cg->scheme = scheme;
+    free(gaps);
+    return cg;
+
+fail:
+    printf("Memory allocation failed\n");
+    free(cg);
+    free(offsets);
+    free(gaps);
+    free(b.bytes);
+    return NULL;
+}
+
+// Compress the out-edges of 'g'
+compressed_graph *compress_graph(graph *g, compression_scheme scheme) {
+    assert(g != NULL);
+    csr_graph *c = build_csr(g);
+    if (c == NULL) {
+        printf("Memory allocation failed\n");
+        return NULL;
+    }
+    compressed_graph *cg = compress_csr(c, scheme);
+    destroy_csr(c);
+    return cg;
+}
+
+void destroy_compressed_graph(compressed_graph *cg) {
+    if (cg != NULL) {
+        free(cg->offsets);
+        free(cg->data);
+        free(cg);
+    }
+}
+
+// Bytes used by the compressed representation, for comparing against CSR
+size_t compressed_graph_bytes(compressed_graph *cg) {
+    return sizeof(*cg) + cg->size + (cg->numnodes + 1) * sizeof(size_t);
+}
+
+int compressed_degree(compressed_graph *cg, int node) {
+    const unsigned char *p = cg->data + cg->offsets[node];
+    return (int)get_varint(&p);
+}
+
+
+// Decode every neighbor of 'node' into 'out' (room for its degree);
+// returns the degree
+int decode_neighbors(compressed_graph *cg, int node, int *out) {
+    const unsigned char *p = cg->data + cg->offsets[node];
+    int deg = (int)get_varint(&p);
+    if (deg == 0) {
+        return 0;
+    }
+    out[0] = node + unzigzag(get_varint(&p));
+    if (cg->scheme == COMPRESS_STREAMVBYTE) {
+#ifdef HAVE_SSSE3_DECODER
+        if (svb_simd_available()) {
+            svb_decode_ssse3(p, deg - 1, out[0], out + 1);
+            return deg;
+        }
+#endif
+        svb_decode_scalar(p, deg - 1, out[0], out + 1);
+    } else {
+        for (int i = 1; i < deg; i++) {
+            out[i] = out[i - 1] + (int)get_varint(&p);
+        }
+    }
+    return deg;
+}
+
+// Streaming access to one neighbor list without decoding it all
+void neighbors_begin(compressed_graph *cg, int node, neighbor_iterator *it) {
+    const unsigned char *p = cg->data + cg->offsets[node];
+    it->scheme = cg->scheme;
+    it->remaining = (int)get_varint(&p);
+    it->index = 0;
+    if (it->remaining > 0) {
+        it->current = node + unzigzag(get_varint(&p));
+    }
+    it->control = p;
+    it->data = p;
+    if (cg->scheme == COMPRESS_STREAMVBYTE && it->remaining > 1) {
+        it->data = p + (it->remaining - 1 + 3) / 4;
+    }
+}
+
+bool neighbors_next(neighbor_iterator *it, int *neighbor) {
+    if (it->remaining == 0) {
+        return false;
+    }
+    *neighbor = it->current;
+    it->remaining--;
+    if (it->remaining > 0) {
+        // Decode the gap to the following neighbor
+        unsigned int gap;
+        if (it->scheme == COMPRESS_STREAMVBYTE) {
+            int len = ((it->control[it->index / 4] >> (2 * (it->index % 4))) & 3) + 1;
+            gap = 0;
+            for (int k = 0; k < len; k++) {
+                gap |= (unsigned int)it->data[k] << (8 * k);
+            }
+            it->data += len;
+        } else {
+            gap = get_varint(&it->data);
+        }
+        it->index++;
+        it->current += (int)gap;
+    }
+    return true;
+}
+
+// BFS over out-edges straight from the compressed lists. 'distances' gets
+// the hop count from 'start' (INF if unreachable); returns nodes reached.
+int compressed_bfs(compressed_graph *cg, int start, int *distances) {
+    assert(cg != NULL && distances != NULL);
+    assert(start >= 0 && start < cg->numnodes);
+    int n = cg->numnodes;
+    int *queue = malloc(n * sizeof(int));
+    if (queue == NULL) {
+        printf("Memory allocation failed\n");
+        return 0;
+    }
+    for (int v = 0; v < n; v++) {
+        distances[v] = INF;
+    }
+
+    int front = 0, rear = 0;
+    distances[start] = 0;
+    queue[rear++] = start;
+    while (front < rear) {
+        int u = queue[front++];
+        neighbor_iterator it;
+        int v;
+        neighbors_begin(cg, u, &it);
+        while (neighbors_next(&it, &v)) {
+            if (distances[v] == INF) {
+                distances[v] = distances[u] + 1;
+                queue[rear++] = v;
+            }
+        }
+    }
+    free(queue);
+    return rear;
+}
+
+// Connected components of a compressed graph built from an undirected CSR
+// (build_csr_undirected). 'component' gets the smallest node id of each
+// component; returns the number of components.
+int compressed_connected_components(compressed_graph *cg, int *component) {
+    assert(cg != NULL && component != NULL);
+    int n = cg->numnodes;
+    int *stack = malloc((n > 0 ? n : 1) * sizeof(int));
+    if (stack == NULL) {
+        printf("Memory allocation failed\n");
+        return -1;
+    }
+    for (int v = 0; v < n; v++) {
+        component[v] = -1;
+    }
+
+    int count = 0;
+    for (int root = 0; root < n; root++) {
+        if (component[root] >= 0) {
+            continue;
+        }
+        count++;
+        int top = 0;
+        stack[top++] = root;
+        component[root] = root;
+        while (top > 0) {
+            int u = stack[--top];
+            neighbor_iterator it;
+            int v;
+            neighbors_begin(cg, u, &it);
+            while (neighbors_next(&it, &v)) {
+                if (component[v] < 0) {
+                    component[v] = root;
+                    stack[top++] = v;
+                }
+            }
+        }
+    }
+    free(stack);
+    return count;
+}
+
+// Same candidates as recommend_friends: nodes reachable from 'user' that are
+// not already its out-neighbors. Writes them to 'out' in increasing id order
+// and returns how many there are, or -1 on allocation failure.
+int compressed_recommend(compressed_graph *cg, int user, int *out) {
+    assert(cg != NULL && out != NULL);
+    int n = cg->numnodes;
+    int *distances = malloc(n * sizeof(int));
+    if (distances == NULL) {
+        printf("Memory allocation failed\n");
+        return -1;
+    }
+    compressed_bfs(cg, user, distances);
+
+    // Direct friends are exactly the nodes at distance 1
+    int count = 0;
+    for (int v = 0; v < n; v++) {
+        if (v != user && distances[v] != INF && distances[v] > 1) {
+            out[count++] = v;
+        }
+    }
+    free(distances);
+    return count;
+}
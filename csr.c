@@ -0,0 +1,208 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include "header.h"
+
+// Allocate an empty CSR with room for 'numedges' neighbor entries
+static csr_graph *alloc_csr(int numnodes, int numedges) {
+    csr_graph *c = malloc(sizeof(*c));
+    if (c == NULL) {
+        return NULL;
+    }
+    c->numnodes = numnodes;
+    c->numedges = numedges;
+    c->offsets = malloc((numnodes + 1) * sizeof(int));
+    c->targets = malloc((numedges > 0 ? numedges : 1) * sizeof(int));
+    c->weights = NULL;
+    if (c->offsets == NULL || c->targets == NULL) {
+        destroy_csr(c);
+        return NULL;
+    }
+    return c;
+}
+
+// Build a CSR from the adjacency matrix. With 'transpose' set, row v lists
+// the in-neighbors of v instead of its out-neighbors.
+static csr_graph *csr_from_matrix(graph *g, bool transpose) {
+    int n = g->numnodes;
+    int m = 0;
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) {
+            if (g->edges[i][j]) {
+                m++;
+            }
+        }
+    }
+
+    csr_graph *c = alloc_csr(n, m);
+    if (c == NULL) {
+        return NULL;
+    }
+
+    // The in-edge index turns the transpose into a row scan
+    bool **rows = transpose && g->in_edges ? g->in_edges : g->edges;
+    bool by_column = transpose && g->in_edges == NULL;
+    int pos = 0;
+    for (int i = 0; i < n; i++) {
+        c->offsets[i] = pos;
+        for (int j = 0; j < n; j++) {
+            if (by_column ? rows[j][i] : rows[i][j]) {
+                c->targets[pos++] = j;
+            }
+        }
+    }
+    c->offsets[n] = pos;
+    return c;
+}
+
+// Out-edge CSR: neighbors of v are targets[offsets[v] .. offsets[v+1]), sorted
+csr_graph *build_csr(graph *g) {
+    assert(g != NULL);
+    return csr_from_matrix(g, false);
+}
+
+// In-edge CSR, used by pull-based kernels
+csr_graph *build_csr_transpose(graph *g) {
+    assert(g != NULL);
+    return csr_from_matrix(g, true);
+}
+
+// Undirected view used by bfs/dfs: v is a neighbor of u when either
+// edges[u][v] or edges[v][u] is set. Self-loops are dropped. With the
+// in-edge index both directions are row scans.
+csr_graph *build_csr_undirected(graph *g) {
+    assert(g != NULL);
+    int n = g->numnodes;
+    int m = 0;
+    for (int i = 0; i < n; i++) {
+        bool *out = g->edges[i];
+        bool *in = g->in_edges ? g->in_edges[i] : NULL;
+        for (int j = 0; j < n; j++) {
+            if (i != j && (out[j] || (in ? in[j] : g->edges[j][i]))) {
+                m++;
+            }
+        }
+    }
+
+    csr_graph *c = alloc_csr(n, m);
+    if (c == NULL) {
+        return NULL;
+    }
+
+    int pos = 0;
+    for (int i = 0; i < n; i++) {
+        bool *out = g->edges[i];
+        bool *in = g->in_edges ? g->in_edges[i] : NULL;
+        c->offsets[i] = pos;
+        for (int j = 0; j < n; j++) {
+            if (i != j && (out[j] || (in ? in[j] : g->edges[j][i]))) {
+                c->targets[pos++] = j;
+            }
+        }
+    }
+    c->offsets[n] = pos;
+    return c;
+}
+
+static int compare_targets(const void *a, const void *b) {
+    const edge *x = a, *y = b;
+    return (x->to > y->to) - (x->to < y->to);
+}
+
+// Weighted CSR from an edge list, for weighted algorithms the bool matrix
+// cannot express. Rows are sorted by target; parallel edges are kept.
+csr_graph *build_csr_from_edges(int numnodes, const edge *edges, int numedges) {
+    assert(edges != NULL || numedges == 0);
+    csr_graph *c = alloc_csr(numnodes, numedges);
+    edge *sorted = malloc((numedges > 0 ? numedges : 1) * sizeof(edge));
+    if (c != NULL) {
+        c->weights = malloc((numedges > 0 ? numedges : 1) * sizeof(int));
+    }
+    if (c == NULL || sorted == NULL || c->weights == NULL) {
+        destroy_csr(c);
+        free(sorted);
+        return NULL;
+    }
+
+    // Counting sort by source, then order each row by target
+    for (int v = 0; v <= numnodes; v++) {
+        c->offsets[v] = 0;
+    }
+    for (int k = 0; k < numedges; k++) {
+        assert(edges[k].from >= 0 && edges[k].from < numnodes);
+        assert(edges[k].to >= 0 && edges[k].to < numnodes);
+        c->offsets[edges[k].from + 1]++;
+    }
+    for (int v = 0; v < numnodes; v++) {
+        c->offsets[v + 1] += c->offsets[v];
+    }
+    for (int k = 0; k < numedges; k++) {
+        sorted[c->offsets[edges[k].from]++] = edges[k];
+    }
+    for (int v = numnodes; v > 0; v--) {
+        c->offsets[v] = c->offsets[v - 1];
+    }
+    c->offsets[0] = 0;
+
+    for (int v = 0; v < numnodes; v++) {
+        int first = c->offsets[v], count = c->offsets[v + 1] - first;
+        qsort(sorted + first, count, sizeof(edge), compare_targets);
+    }
+    for (int k = 0; k < numedges; k++) {
+        c->targets[k] = sorted[k].to;
+        c->weights[k] = sorted[k].weight;
+    }
+    free(sorted);
+    return c;
+}
+
+// Reverse every edge of a CSR, keeping weights. Rows stay sorted because
+// sources are visited in ascending order.
+csr_graph *csr_transpose(csr_graph *c) {
+    assert(c != NULL);
+    int n = c->numnodes;
+    csr_graph *t = alloc_csr(n, c->numedges);
+    if (t != NULL && c->weights != NULL) {
+        t->weights = malloc((c->numedges > 0 ? c->numedges : 1) * sizeof(int));
+        if (t->weights == NULL) {
+            destroy_csr(t);
+            t = NULL;
+        }
+    }
+    if (t == NULL) {
+        return NULL;
+    }
+
+    for (int v = 0; v <= n; v++) {
+        t->offsets[v] = 0;
+    }
+    for (int k = 0; k < c->numedges; k++) {
+        t->offsets[c->targets[k] + 1]++;
+    }
+    for (int v = 0; v < n; v++) {
+        t->offsets[v + 1] += t->offsets[v];
+    }
+    for (int u = 0; u < n; u++) {
+        for (int k = c->offsets[u]; k < c->offsets[u + 1]; k++) {
+            int slot = t->offsets[c->targets[k]]++;
+            t->targets[slot] = u;
+            if (c->weights != NULL) {
+                t->weights[slot] = c->weights[k];
+            }
+        }
+    }
+    for (int v = n; v > 0; v--) {
+        t->offsets[v] = t->offsets[v - 1];
+    }
+    t->offsets[0] = 0;
+    return t;
+}
+
+void destroy_csr(csr_graph *c) {
+    if (c != NULL) {
+        free(c->offsets);
+        free(c->targets);
+        free(c->weights);
+        free(c);
+    }
+}
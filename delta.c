@@ -0,0 +1,481 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <assert.h>
+#include "header.h"
+
+// Delta-stepping (Meyer and Sanders). Nodes wait in buckets of width delta
+// by tentative distance. The lowest non-empty bucket is settled by
+// relaxing the light arcs (weight <= delta) of all its nodes in parallel
+// until the bucket stays empty, then the heavy arcs of every node it
+// settled once. Distances are lowered with a compare-and-swap minimum.
+//
+// Each worker appends to its own bucket lists. Only a window of buckets
+// past the current one has list slots; farther nodes (possible only when
+// the window is capped) wait in a per-worker overflow list.
+
+#define MAX_SLOTS 4096      // bucket window cap, per worker
+#define SAMPLE_SIZE 1024    // arc weights sampled when tuning delta
+
+typedef struct {
+    int *nodes;
+    int count;
+    int capacity;
+} node_list;
+
+typedef struct {
+    _Alignas(64) node_list *slots;  // bucket b lives in slot b % numslots
+    node_list far;                  // buckets past the window
+    node_list settled;              // nodes scanned in the current bucket
+    int far_min;                    // lowest bucket appended to 'far'
+    bool failed;
+} bucket_worker;
+
+typedef struct {
+    csr_graph *c;
+    int delta;
+    int *dist;
+    int *scanned;           // 1 + last bucket each node was scanned in
+    int current;            // bucket being settled
+    int numslots;
+    unsigned char *occupied;    // slot got nodes since it was last gathered
+    int numworkers;
+    bucket_worker *workers;
+    int *frontier;
+    int frontiercap;
+    int *starts;            // where each worker's list lands in the frontier
+    int gather_slot;        // slot being gathered, -1 for the settled lists
+    uint64_t *best;         // (distance, id) of each node's best predecessor
+    int *hops;              // fewest tight arcs from the source, NULL if no arc weighs 0
+} delta_state;
+
+static bool append_node(node_list *list, int v) {
+    if (list->count == list->capacity) {
+        int capacity = list->capacity ? list->capacity * 2 : 16;
+        int *nodes = realloc(list->nodes, capacity * sizeof(int));
+        if (nodes == NULL) {
+            return false;
+        }
+        list->nodes = nodes;
+        list->capacity = capacity;
+    }
+    list->nodes[list->count++] = v;
+    return true;
+}
+
+// Queue v at distance d in the calling worker's bucket lists
+static void push_node(delta_state *s, bucket_worker *w, int v, int d) {
+    int b = d / s->delta;
+    node_list *list;
+    if (b - s->current < s->numslots) {
+        int slot = b % s->numslots;
+        list = &w->slots[slot];
+        if (!__atomic_load_n(&s->occupied[slot], __ATOMIC_RELAXED)) {
+            __atomic_store_n(&s->occupied[slot], 1, __ATOMIC_RELAXED);
+        }
+    } else {
+        list = &w->far;
+        w->far_min = b < w->far_min ? b : w->far_min;
+    }
+    if (!append_node(list, v)) {
+        w->failed = true;
+    }
+}
+
+// Lower the distance of each light (or heavy) arc target of u
+static void relax_arcs(delta_state *s, bucket_worker *w, int u, int du, bool heavy) {
+    csr_graph *c = s->c;
+    for (int k = c->offsets[u]; k < c->offsets[u + 1]; k++) {
+        int weight = c->weights ? c->weights[k] : 1;
+        if ((weight > s->delta) != heavy) {
+            continue;
+        }
+        int v = c->targets[k];
+        int alt = du + weight;
+        int old = __atomic_load_n(&s->dist[v], __ATOMIC_RELAXED);
+        while (alt < old) {
+            if (__atomic_compare_exchange_n(&s->dist[v], &old, alt, true, __ATOMIC_RELAXED,
+                                            __ATOMIC_RELAXED)) {
+                push_node(s, w, v, alt);
+                break;
+            }
+        }
+    }
+}
+
+static void copy_lists(int begin, int end, int worker, void *arg) {
+    delta_state *s = arg;
+    for (int i = begin; i < end; i++) {
+        bucket_worker *w = &s->workers[i];
+        node_list *list = s->gather_slot < 0 ? &w->settled : &w->slots[s->gather_slot];
+        if (list->count > 0) {
+            memcpy(s->frontier + s->starts[i], list->nodes, list->count * sizeof(int));
+        }
+        list->count = 0;
+    }
+}
+
+// Move every worker's list for 'slot' (-1: the settled lists) into the
+// shared frontier. Returns its size, -1 on allocation failure.
+static int gather_frontier(delta_state *s, int slot) {
+    int total = 0;
+    for (int i = 0; i < s->numworkers; i++) {
+        bucket_worker *w = &s->workers[i];
+        s->starts[i] = total;
+        total += slot < 0 ? w->settled.count : w->slots[slot].count;
+    }
+    if (total > s->frontiercap) {
+        int *frontier = realloc(s->frontier, total * sizeof(int));
+        if (frontier == NULL) {
+            return -1;
+        }
+        s->frontier = frontier;
+        s->frontiercap = total;
+    }
+    s->gather_slot = slot;
+    parallel_for(0, s->numworkers, 1, copy_lists, s);
+    return total;
+}
+
+static void scan_light(int begin, int end, int worker, void *arg) {
+    delta_state *s = arg;
+    bucket_worker *w = &s->workers[worker];
+    for (int i = begin; i < end; i++) {
+        int v = s->frontier[i];
+        int dv = __atomic_load_n(&s->dist[v], __ATOMIC_RELAXED);
+        if (dv / s->delta != s->current) {
+            continue;   // settled in an earlier bucket
+        }
+        int stamp = s->current + 1;
+        if (__atomic_exchange_n(&s->scanned[v], stamp, __ATOMIC_RELAXED) != stamp &&
+            !append_node(&w->settled, v)) {
+            w->failed = true;
+        }
+        relax_arcs(s, w, v, dv, false);
+    }
+}
+
+static void scan_heavy(int begin, int end, int worker, void *arg) {
+    delta_state *s = arg;
+    bucket_worker *w = &s->workers[worker];
+    for (int i = begin; i < end; i++) {
+        int v = s->frontier[i];
+        relax_arcs(s, w, v, s->dist[v], true);
+    }
+}
+
+// Lowest bucket after the current one, pulling overflow nodes into the
+// window when one of them comes first. Returns INF when none is left.
+static int next_bucket(delta_state *s) {
+    int next = INF;
+    for (int b = s->current + 1; b - s->current < s->numslots; b++) {
+        if (s->occupied[b % s->numslots]) {
+            next = b;
+            break;
+        }
+    }
+    int far_min = INF;
+    for (int i = 0; i < s->numworkers; i++) {
+        far_min = s->workers[i].far_min < far_min ? s->workers[i].far_min : far_min;
+    }
+    if (far_min > next) {
+        return next;
+    }
+
+    // Overflow entries hold the bucket of their distance when queued; nodes
+    // settled since then are dropped
+    int lowest = next;
+    for (int i = 0; i < s->numworkers; i++) {
+        node_list *far = &s->workers[i].far;
+        for (int k = 0; k < far->count; k++) {
+            int b = s->dist[far->nodes[k]] / s->delta;
+            lowest = b > s->current && b < lowest ? b : lowest;
+        }
+    }
+    if (lowest == INF) {
+        for (int i = 0; i < s->numworkers; i++) {
+            s->workers[i].far.count = 0;
+            s->workers[i].far_min = INF;
+        }
+        return INF;
+    }
+    s->current = lowest - 1;    // push_node measures the window from here
+    for (int i = 0; i < s->numworkers; i++) {
+        bucket_worker *w = &s->workers[i];
+        int kept = 0;
+        w->far_min = INF;
+        for (int k = 0; k < w->far.count; k++) {
+            int v = w->far.nodes[k];
+            int b = s->dist[v] / s->delta;
+            if (b <= lowest - 1) {
+                continue;
+            }
+            if (b - lowest < s->numslots - 1) {
+                push_node(s, w, v, s->dist[v]);
+            } else {
+                w->far.nodes[kept++] = v;
+                w->far_min = b < w->far_min ? b : w->far_min;
+            }
+        }
+        w->far.count = kept;
+    }
+    return lowest;
+}
+
+// One level of a BFS over the tight arcs: nodes of the frontier are at
+// 'level' hops, newly reached ones land in the workers' settled lists
+static void expand_tight(int begin, int end, int worker, void *arg) {
+    delta_state *s = arg;
+    bucket_worker *w = &s->workers[worker];
+    csr_graph *c = s->c;
+    for (int i = begin; i < end; i++) {
+        int u = s->frontier[i];
+        int du = s->dist[u];
+        int level = s->hops[u];
+        for (int k = c->offsets[u]; k < c->offsets[u + 1]; k++) {
+            int v = c->targets[k];
+            int unseen = INF;
+            if (s->dist[v] == INF || du + (c->weights ? c->weights[k] : 1) != s->dist[v] ||
+                __atomic_load_n(&s->hops[v], __ATOMIC_RELAXED) != INF) {
+                continue;
+            }
+            if (__atomic_compare_exchange_n(&s->hops[v], &unseen, level + 1, false,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED) &&
+                !append_node(&w->settled, v)) {
+                w->failed = true;
+            }
+        }
+    }
+}
+
+// Fill s->hops level by level from the source
+static bool count_tight_hops(delta_state *s, int source) {
+    for (int v = 0; v < s->c->numnodes; v++) {
+        s->hops[v] = INF;
+    }
+    s->hops[source] = 0;
+    if (!append_node(&s->workers[0].settled, source)) {
+        return false;
+    }
+    int size;
+    while ((size = gather_frontier(s, -1)) > 0) {
+        parallel_for(0, size, 0, expand_tight, s);
+        for (int i = 0; i < s->numworkers; i++) {
+            if (s->workers[i].failed) {
+                return false;
+            }
+        }
+    }
+    return size == 0;
+}
+
+static void pack_predecessors(int begin, int end, int worker, void *arg) {
+    delta_state *s = arg;
+    csr_graph *c = s->c;
+    for (int u = begin; u < end; u++) {
+        int du = s->dist[u];
+        if (du == INF) {
+            continue;
+        }
+        uint64_t key = (uint64_t)du << 32 | (uint32_t)u;
+        for (int k = c->offsets[u]; k < c->offsets[u + 1]; k++) {
+            int v = c->targets[k];
+            if (s->dist[v] == INF || du + (c->weights ? c->weights[k] : 1) != s->dist[v]) {
+                continue;
+            }
+            // A zero-weight arc only counts when it comes from closer to the
+            // source in hops, so predecessor chains cannot loop
+            if (du == s->dist[v] && s->hops[u] >= s->hops[v]) {
+                continue;
+            }
+            uint64_t old = __atomic_load_n(&s->best[v], __ATOMIC_RELAXED);
+            while (key < old && !__atomic_compare_exchange_n(&s->best[v], &old, key, true,
+                                                             __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+            }
+        }
+    }
+}
+
+// Predecessor of each node: the tight in-neighbor with the lowest (distance,
+// id), which is the one an array-scan Dijkstra settles first. Through
+// zero-weight arcs only in-neighbors fewer tight arcs from the source count.
+static bool fill_predecessors(delta_state *s, int source, int *predecessors) {
+    int n = s->c->numnodes;
+    if (s->hops != NULL && !count_tight_hops(s, source)) {
+        return false;
+    }
+    s->best = malloc((n > 0 ? n : 1) * sizeof(uint64_t));
+    if (s->best == NULL) {
+        return false;
+    }
+    for (int v = 0; v < n; v++) {
+        s->best[v] = UINT64_MAX;
+    }
+    parallel_for(0, n, 0, pack_predecessors, s);
+    for (int v = 0; v < n; v++) {
+        predecessors[v] = v == source || s->best[v] == UINT64_MAX ? -1 : (int)(uint32_t)s->best[v];
+    }
+    free(s->best);
+    return true;
+}
+
+// Bucket width tuned to the weight distribution: the 1 / (average degree)
+// quantile of a sample of arc weights, so a node has about one light arc
+// (delta = max weight / degree for uniform weights, as Meyer and Sanders
+// suggest). Unit weights give delta 1, a level-synchronous BFS.
+int choose_delta(csr_graph *c) {
+    assert(c != NULL);
+    if (c->weights == NULL || c->numedges == 0) {
+        return 1;
+    }
+    int count = c->numedges < SAMPLE_SIZE ? c->numedges : SAMPLE_SIZE;
+    int sample[SAMPLE_SIZE];
+    for (int i = 0; i < count; i++) {
+        int w = c->weights[(long long)i * c->numedges / count];
+        int pos = i;
+        while (pos > 0 && sample[pos - 1] > w) {
+            sample[pos] = sample[pos - 1];
+            pos--;
+        }
+        sample[pos] = w;
+    }
+    double degree = (double)c->numedges / c->numnodes;
+    double quantile = degree > 1.0 ? 1.0 / degree : 1.0;
+    int delta = sample[(int)(quantile * (count - 1))];
+    return delta > 0 ? delta : 1;
+}
+
+static void destroy_state(delta_state *s) {
+    for (int i = 0; s->workers != NULL && i < s->numworkers; i++) {
+        bucket_worker *w = &s->workers[i];
+        for (int slot = 0; w->slots != NULL && slot < s->numslots; slot++) {
+            free(w->slots[slot].nodes);
+        }
+        free(w->slots);
+        free(w->far.nodes);
+        free(w->settled.nodes);
+    }
+    free_aligned(s->workers);
+    free(s->scanned);
+    free(s->occupied);
+    free(s->frontier);
+    free(s->starts);
+}
+
+// Parallel single-source shortest paths over a CSR with non-negative
+// weights; 'delta' <= 0 picks one with choose_delta. Distances and
+// predecessors (-1 for the source and unreached nodes) match a full
+// Dijkstra run with ties settled by node id; zero-weight arcs still give
+// a predecessor tree, though not always Dijkstra's. With a 'target' (>= 0) the
+// search stops once the target's bucket is settled, and nodes beyond that
+// bucket are left at INF. Returns false on allocation failure.
+bool delta_stepping(csr_graph *c, int source, int target, int delta, int *distances,
+                    int *predecessors) {
+    assert(c != NULL && distances != NULL && predecessors != NULL);
+    assert(source >= 0 && source < c->numnodes && target < c->numnodes);
+    int n = c->numnodes;
+    delta_state s = {0};
+    s.c = c;
+    s.delta = delta > 0 ? delta : choose_delta(c);
+    s.dist = distances;
+
+    // The window spans every bucket a heavy arc can reach from the current one
+    int maxweight = 1;
+    bool zero = false;
+    for (int k = 0; c->weights != NULL && k < c->numedges; k++) {
+        maxweight = c->weights[k] > maxweight ? c->weights[k] : maxweight;
+        zero = zero || c->weights[k] == 0;
+    }
+    s.numslots = maxweight / s.delta + 2 < MAX_SLOTS ? maxweight / s.delta + 2 : MAX_SLOTS;
+    s.numworkers = scheduler_acquire();
+    s.scanned = calloc(n > 0 ? n : 1, sizeof(int));
+    s.occupied = calloc(s.numslots, sizeof(unsigned char));
+    s.starts = malloc(s.numworkers * sizeof(int));
+    s.workers = alloc_aligned(s.numworkers * sizeof(bucket_worker));
+    bool ok = s.scanned && s.occupied && s.starts && s.workers;
+    if (s.workers != NULL) {
+        memset(s.workers, 0, s.numworkers * sizeof(bucket_worker));
+    }
+    for (int i = 0; ok && i < s.numworkers; i++) {
+        s.workers[i].slots = calloc(s.numslots, sizeof(node_list));
+        s.workers[i].far_min = INF;
+        ok = s.workers[i].slots != NULL;
+    }
+    if (!ok) {
+        printf("Memory allocation failed\n");
+        destroy_state(&s);
+        scheduler_release();
+        return false;
+    }
+
+    for (int v = 0; v < n; v++) {
+        distances[v] = INF;
+    }
+    distances[source] = 0;
+    push_node(&s, &s.workers[0], source, 0);
+
+    long long bound = (long long)INF + 1;   // distances below this are final
+    while (ok) {
+        int slot = s.current % s.numslots;
+        while (ok && s.occupied[slot]) {
+            s.occupied[slot] = 0;
+            int size = gather_frontier(&s, slot);
+            ok = size >= 0;
+            if (ok) {
+                parallel_for(0, size, 0, scan_light, &s);
+            }
+        }
+        int size = ok ? gather_frontier(&s, -1) : -1;
+        ok = size >= 0;
+        if (ok) {
+            parallel_for(0, size, 0, scan_heavy, &s);
+        }
+        for (int i = 0; i < s.numworkers; i++) {
+            ok = ok && !s.workers[i].failed;
+        }
+
+        if (target >= 0 && distances[target] != INF && distances[target] / s.delta <= s.current) {
+            bound = ((long long)s.current + 1) * s.delta;
+            break;
+        }
+        s.current = next_bucket(&s);
+        if (s.current == INF) {
+            break;
+        }
+    }
+
+    if (ok) {
+        for (int v = 0; v < n; v++) {
+            distances[v] = distances[v] < bound ? distances[v] : INF;
+        }
+        s.hops = zero ? s.scanned : NULL;   // bucket stamps are no longer needed
+        ok = fill_predecessors(&s, source, predecessors);
+    }
+    destroy_state(&s);
+    scheduler_release();
+    if (!ok) {
+        printf("Memory allocation failed\n");
+    }
+    return ok;
+}
+
+// Drop-in alternative to shortest_path_dijkstra that spreads the search
+// over the scheduler's threads
+int *shortest_path_delta_stepping(graph *g, int start_node, int end_node, int **predecessors) {
+    csr_graph *c = build_csr(g);
+    int *distances = malloc(g->numnodes * sizeof(int));
+    *predecessors = malloc(g->numnodes * sizeof(int));
+    bool allocated = c != NULL && distances != NULL && *predecessors != NULL;
+    if (!allocated) {
+        printf("Memory allocation failed\n");     // delta_stepping reports its own
+    }
+    if (!allocated || !delta_stepping(c, start_node, end_node, 0, distances, *predecessors)) {
+        destroy_csr(c);
+        free(distances);
+        free(*predecessors);
+        return NULL;
+    }
+    destroy_csr(c);
+    return distances;
+}
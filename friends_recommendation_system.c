@@ -2,8 +2,11 @@
 #include <stdlib.h>
 #include "header.h" // Include your graph library header
 
+#define MAX_RECOMMENDATIONS 10
+
 // Function to recommend friends for a user
-void recommend_friends(graph *g, int user) {
+void recommend_friends(graph *g, csr_graph **ppr_view, ppr_workspace **ppr_ws, int user,
+                       recommend_mode mode) {
     printf("\n===== Friend Recommendations for User %d =====\n", user);
 
     if (user < 0 || user >= g->numnodes) {
@@ -11,6 +14,11 @@ void recommend_friends(graph *g, int user) {
         return;
     }
 
+    if (mode != RECOMMEND_REACHABLE) {
+        recommend_friends_ppr(g, ppr_view, ppr_ws, user, MAX_RECOMMENDATIONS, mode);
+        return;
+    }
+
     int *distances = NULL;
     int *predecessors = NULL;
 
@@ -56,10 +64,19 @@ int main() {
     }
 
     int choice, from, to, user;
+    csr_graph *separation_view = NULL;
+    alt_index *separation_index = NULL;
+    alt_workspace *separation_ws = NULL;
+    csr_graph *ppr_view = NULL;
+    ppr_workspace *ppr_ws = NULL;
     do {
         printf("\n===== Friend Recommendation System =====\n");
         printf("1. Add Friendship\n");
         printf("2. Recommend Friends for a User\n");
+        printf("3. Recommend Friends by Personalized PageRank\n");
+        printf("4. Recommend Friends by Random Walks\n");
+        printf("5. Show Clustering Coefficients\n");
+        printf("6. Degrees of Separation\n");
         printf("0. Exit\n");
         printf("Enter your choice: ");
         scanf("%d", &choice);
@@ -72,6 +89,14 @@ int main() {
                     printf("Invalid user IDs. Please try again.\n");
                 } else if (add_edge(social_network, from, to)) {
                     printf("Friendship added between User %d and User %d.\n", from, to);
+                    destroy_alt(separation_index);
+                    destroy_csr(separation_view);
+                    destroy_alt_workspace(separation_ws);
+                    destroy_csr(ppr_view);
+                    separation_index = NULL;
+                    separation_ws = NULL;
+                    separation_view = NULL;
+                    ppr_view = NULL;
                 } else {
                     printf("Failed to add friendship. It might already exist.\n");
                 }
@@ -80,7 +105,40 @@ int main() {
             case 2: // Recommend friends
                 printf("Enter the user ID to recommend friends for: ");
                 scanf("%d", &user);
-                recommend_friends(social_network, user);
+                recommend_friends(social_network, &ppr_view, &ppr_ws, user, RECOMMEND_REACHABLE);
+                break;
+
+            case 3: // Recommend friends by personalized PageRank
+                printf("Enter the user ID to recommend friends for: ");
+                scanf("%d", &user);
+                recommend_friends(social_network, &ppr_view, &ppr_ws, user, RECOMMEND_PPR_PUSH);
+                break;
+
+            case 4: // Recommend friends by push plus random walks
+                printf("Enter the user ID to recommend friends for: ");
+                scanf("%d", &user);
+                recommend_friends(social_network, &ppr_view, &ppr_ws, user, RECOMMEND_PPR_WALK);
+                break;
+
+            case 5: { // Clustering coefficients (low values with high degree flag spam)
+                triangle_stats *stats = count_triangles(social_network);
+                if (!stats) {
+                    printf("Failed to count triangles.\n");
+                    break;
+                }
+                printf("Transitivity of the network: %.4f\n", stats->transitivity);
+                for (int i = 0; i < num_users; i++) {
+                    printf("User %d: %lld triangles, clustering %.4f\n", i, stats->per_node[i], stats->clustering[i]);
+                }
+                destroy_triangle_stats(stats);
+                break;
+            }
+
+            case 6: // Degrees of separation
+                printf("Enter the two user IDs (from to): ");
+                scanf("%d %d", &from, &to);
+                degrees_of_separation(social_network, &separation_view, &separation_index,
+                                      &separation_ws, from, to);
                 break;
 
             case 0: // Exit
@@ -93,6 +151,11 @@ int main() {
     } while (choice != 0);
 
     // Clean up
+    destroy_alt(separation_index);
+    destroy_csr(separation_view);
+    destroy_alt_workspace(separation_ws);
+    destroy_csr(ppr_view);
+    destroy_ppr_workspace(ppr_ws);
     destroy_graph(social_network);
 
     return 0;
@@ -0,0 +1,449 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "header.h"
+
+// Grid engine: a 4-connected map loaded once and queried many times. Cells
+// are numbered row-major; Node.x is the row and Node.y the column, as in the
+// visualizer. Goals with a precomputed field are answered by walking its
+// flow; any other query runs a BFS in a per-worker search kept by the map.
+
+#define NO_MOVE 4
+
+// Moves in the visualizer's order: up, down, left, right. Move d ^ 1 undoes d.
+static const int step_x[] = {-1, 1, 0, 0};
+static const int step_y[] = {0, 0, -1, 1};
+
+struct grid_search {
+    int *dist;              // INF outside the last search
+    unsigned char *from;    // move that reached each cell
+    int *queue;             // also the list of cells to reset
+    int numqueued;
+};
+
+typedef struct {
+    Node *cells;
+    int count;
+    int capacity;
+} cell_buffer;
+
+static bool open_cell(grid_map *m, int x, int y) {
+    return x >= 0 && x < m->rows && y >= 0 && y < m->cols && m->open[x * m->cols + y];
+}
+
+// Map from row-major cells; '#' is a wall, anything else is open
+grid_map *create_grid_map(int rows, int cols, const char *cells) {
+    assert(rows >= 0 && cols >= 0 && (cells != NULL || rows * cols == 0));
+    grid_map *m = calloc(1, sizeof(*m));
+    if (m == NULL) {
+        printf("Memory allocation failed\n");
+        return NULL;
+    }
+    int numcells = rows * cols > 0 ? rows * cols : 1;
+    m->rows = rows;
+    m->cols = cols;
+    m->open = malloc(numcells * sizeof(unsigned char));
+    m->field_at = malloc(numcells * sizeof(int));
+    if (m->open == NULL || m->field_at == NULL) {
+        printf("Memory allocation failed\n");
+        destroy_grid_map(m);
+        return NULL;
+    }
+    for (int i = 0; i < rows * cols; i++) {
+        m->open[i] = cells[i] != '#';
+        m->field_at[i] = -1;
+    }
+    return m;
+}
+
+// Map in initGrid's format: "rows cols" followed by one word per row
+grid_map *read_grid_map(FILE *in) {
+    int rows, cols;
+    if (fscanf(in, "%d %d", &rows, &cols) != 2 || rows <= 0 || cols <= 0) {
+        printf("Invalid grid dimensions\n");
+        return NULL;
+    }
+    char *cells = malloc((size_t)rows * cols + 1);
+    char *line = malloc(cols + 1);
+    if (cells == NULL || line == NULL) {
+        printf("Memory allocation failed\n");
+        free(cells);
+        free(line);
+        return NULL;
+    }
+    char format[32];
+    snprintf(format, sizeof(format), "%%%ds", cols);
+    for (int i = 0; i < rows; i++) {
+        if (fscanf(in, format, line) != 1 || (int)strlen(line) != cols) {
+            printf("Invalid grid row %d\n", i);
+            free(cells);
+            free(line);
+            return NULL;
+        }
+        memcpy(cells + (size_t)i * cols, line, cols);
+    }
+    grid_map *m = create_grid_map(rows, cols, cells);
+    free(cells);
+    free(line);
+    return m;
+}
+
+static void destroy_search(grid_search *s) {
+    if (s != NULL) {
+        free(s->dist);
+        free(s->from);
+        free(s->queue);
+        free(s);
+    }
+}
+
+void destroy_grid_map(grid_map *m) {
+    if (m != NULL) {
+        for (int i = 0; i < m->numfields; i++) {
+            free(m->fields[i].dist);
+            free(m->fields[i].flow);
+        }
+        for (int i = 0; i < m->numsearches; i++) {
+            destroy_search(m->searches[i]);
+        }
+        free(m->fields);
+        free(m->searches);
+        free(m->open);
+        free(m->field_at);
+        free(m);
+    }
+}
+
+// BFS outward from 'source'. 'from' gets the move that reached each cell,
+// or with 'toward' set the move leading back toward the source. Stops once
+// 'target' (-1: none) is reached. Returns the number of cells queued.
+static int grid_bfs(grid_map *m, int source, int target, int *dist, unsigned char *from,
+                    int *queue, bool toward) {
+    int head = 0, tail = 0;
+    dist[source] = 0;
+    from[source] = NO_MOVE;
+    queue[tail++] = source;
+    while (head < tail) {
+        int u = queue[head++];
+        if (u == target) {
+            break;
+        }
+        int x = u / m->cols, y = u % m->cols;
+        for (int d = 0; d < 4; d++) {
+            int nx = x + step_x[d], ny = y + step_y[d];
+            if (!open_cell(m, nx, ny)) {
+                continue;
+            }
+            int v = nx * m->cols + ny;
+            if (dist[v] == INF) {
+                dist[v] = dist[u] + 1;
+                from[v] = toward ? d ^ 1 : d;
+                queue[tail++] = v;
+            }
+        }
+    }
+    return tail;
+}
+
+typedef struct {
+    grid_map *m;
+    int first;              // index of the first new field
+    int **queues;           // one BFS queue per worker
+} field_job;
+
+static void build_fields(int begin, int end, int worker, void *arg) {
+    field_job *job = arg;
+    grid_map *m = job->m;
+    for (int i = begin; i < end; i++) {
+        grid_field *f = &m->fields[job->first + i];
+        grid_bfs(m, f->goal.x * m->cols + f->goal.y, -1, f->dist, f->flow, job->queues[worker],
+                 true);
+    }
+}
+
+// Precompute distance and flow fields toward each goal, in parallel. Walls,
+// cells off the map and goals that already have a field are skipped.
+// Returns false on allocation failure.
+bool add_grid_fields(grid_map *m, const Node *goals, int numgoals) {
+    assert(m != NULL && (goals != NULL || numgoals == 0));
+    int numcells = m->rows * m->cols;
+    grid_field *fields = realloc(m->fields, (m->numfields + numgoals + 1) * sizeof(grid_field));
+    if (fields == NULL) {
+        printf("Memory allocation failed\n");
+        return false;
+    }
+    m->fields = fields;
+
+    int first = m->numfields;
+    bool ok = true;
+    for (int i = 0; ok && i < numgoals; i++) {
+        Node g = goals[i];
+        if (!open_cell(m, g.x, g.y) || m->field_at[g.x * m->cols + g.y] >= 0) {
+            continue;
+        }
+        grid_field *f = &m->fields[m->numfields];
+        f->goal = g;
+        f->dist = malloc(numcells * sizeof(int));
+        f->flow = malloc(numcells * sizeof(unsigned char));
+        if (f->dist == NULL || f->flow == NULL) {
+            free(f->dist);
+            free(f->flow);
+            ok = false;
+            break;
+        }
+        for (int c = 0; c < numcells; c++) {
+            f->dist[c] = INF;
+            f->flow[c] = NO_MOVE;
+        }
+        m->field_at[g.x * m->cols + g.y] = m->numfields++;
+    }
+
+    int numworkers = scheduler_acquire();
+    int **queues = calloc(numworkers, sizeof(int *));
+    ok = ok && queues != NULL;
+    for (int w = 0; ok && w < numworkers; w++) {
+        queues[w] = malloc(numcells * sizeof(int));
+        ok = queues[w] != NULL;
+    }
+    if (ok) {
+        field_job job = {m, first, queues};
+        parallel_for(0, m->numfields - first, 1, build_fields, &job);
+    } else {
+        // Leave the map as it was
+        while (m->numfields > first) {
+            grid_field *f = &m->fields[--m->numfields];
+            m->field_at[f->goal.x * m->cols + f->goal.y] = -1;
+            free(f->dist);
+            free(f->flow);
+        }
+        printf("Memory allocation failed\n");
+    }
+    for (int w = 0; queues != NULL && w < numworkers; w++) {
+        free(queues[w]);
+    }
+    free(queues);
+    scheduler_release();
+    return ok;
+}
+
+static grid_search *create_search(int numcells) {
+    grid_search *s = calloc(1, sizeof(*s));
+    if (s == NULL) {
+        return NULL;
+    }
+    int n = numcells > 0 ? numcells : 1;
+    s->dist = malloc(n * sizeof(int));
+    s->from = malloc(n * sizeof(unsigned char));
+    s->queue = malloc(n * sizeof(int));
+    if (s->dist == NULL || s->from == NULL || s->queue == NULL) {
+        destroy_search(s);
+        return NULL;
+    }
+    for (int c = 0; c < numcells; c++) {
+        s->dist[c] = INF;
+    }
+    return s;
+}
+
+static bool append_cell(cell_buffer *b, int x, int y) {
+    if (b->count == b->capacity) {
+        int capacity = b->capacity ? b->capacity * 2 : 256;
+        Node *cells = realloc(b->cells, capacity * sizeof(Node));
+        if (cells == NULL) {
+            return false;
+        }
+        b->cells = cells;
+        b->capacity = capacity;
+    }
+    b->cells[b->count++] = (Node){x, y};
+    return true;
+}
+
+// Append the cells from 'cell' until a NO_MOVE cell, stepping along each
+// move, or against it when 'moves' records how a cell was reached
+static bool append_walk(grid_map *m, cell_buffer *b, int cell, const unsigned char *moves,
+                        bool against) {
+    for (;;) {
+        int x = cell / m->cols, y = cell % m->cols;
+        if (!append_cell(b, x, y)) {
+            return false;
+        }
+        int d = moves[cell];
+        if (d == NO_MOVE) {
+            return true;
+        }
+        int step = against ? d ^ 1 : d;
+        cell = (x + step_x[step]) * m->cols + (y + step_y[step]);
+    }
+}
+
+static void reverse_cells(cell_buffer *b, int first) {
+    for (int i = first, j = b->count - 1; i < j; i++, j--) {
+        Node t = b->cells[i];
+        b->cells[i] = b->cells[j];
+        b->cells[j] = t;
+    }
+}
+
+typedef struct {
+    grid_map *m;
+    const grid_query *queries;
+    cell_buffer *buffers;   // one per worker
+    int *owner;             // worker holding each path
+    int *where;             // its first cell in that worker's buffer
+    int *lengths;
+    int *offsets;
+    Node *cells;
+    bool failed;
+} route_job;
+
+// Shortest path of one query into the worker's buffer; returns its length
+// in steps, -1 when unreachable, -2 when out of memory
+static int route_one(route_job *job, int worker, grid_query q) {
+    grid_map *m = job->m;
+    cell_buffer *b = &job->buffers[worker];
+    if (!open_cell(m, q.start.x, q.start.y) || !open_cell(m, q.end.x, q.end.y)) {
+        return -1;
+    }
+    int source = q.start.x * m->cols + q.start.y;
+    int target = q.end.x * m->cols + q.end.y;
+
+    // Fields are symmetric on a 4-connected grid, so either end will do
+    int fi = m->field_at[target] >= 0 ? m->field_at[target] : m->field_at[source];
+    if (fi >= 0) {
+        grid_field *f = &m->fields[fi];
+        bool toward_target = m->field_at[target] == fi;
+        int walk = toward_target ? source : target;
+        if (f->dist[walk] == INF) {
+            return -1;
+        }
+        int first = b->count;
+        if (!append_walk(m, b, walk, f->flow, false)) {
+            return -2;
+        }
+        if (!toward_target) {
+            reverse_cells(b, first);
+        }
+        return f->dist[walk];
+    }
+
+    if (m->searches[worker] == NULL) {
+        m->searches[worker] = create_search(m->rows * m->cols);
+        if (m->searches[worker] == NULL) {
+            return -2;
+        }
+    }
+    grid_search *s = m->searches[worker];
+    s->numqueued = grid_bfs(m, source, target, s->dist, s->from, s->queue, false);
+    int length = s->dist[target];
+    int first = b->count;
+    bool ok = length == INF || append_walk(m, b, target, s->from, true);
+    if (ok) {
+        reverse_cells(b, first);
+    }
+    for (int i = 0; i < s->numqueued; i++) {
+        s->dist[s->queue[i]] = INF;
+    }
+    if (!ok) {
+        return -2;
+    }
+    return length == INF ? -1 : length;
+}
+
+static void route_queries(int begin, int end, int worker, void *arg) {
+    route_job *job = arg;
+    for (int i = begin; i < end; i++) {
+        job->owner[i] = worker;
+        job->where[i] = job->buffers[worker].count;
+        int length = route_one(job, worker, job->queries[i]);
+        if (length == -2) {
+            __atomic_store_n(&job->failed, true, __ATOMIC_RELAXED);
+            length = -1;
+        }
+        job->lengths[i] = length;
+    }
+}
+
+static void copy_paths(int begin, int end, int worker, void *arg) {
+    route_job *job = arg;
+    for (int i = begin; i < end; i++) {
+        int count = job->offsets[i + 1] - job->offsets[i];
+        if (count > 0) {    // an empty worker buffer may never have been allocated
+            memcpy(job->cells + job->offsets[i], job->buffers[job->owner[i]].cells + job->where[i],
+                   count * sizeof(Node));
+        }
+    }
+}
+
+// Shortest 4-connected paths for a batch of queries, in parallel. Path i
+// runs from queries[i].start to queries[i].end inclusive and has
+// lengths[i] steps; unreachable queries get length -1 and no cells. Only
+// one batch may run on a map at a time. Returns NULL on allocation failure.
+grid_paths *grid_route(grid_map *m, const grid_query *queries, int numqueries) {
+    assert(m != NULL && (queries != NULL || numqueries == 0));
+    int numworkers = scheduler_acquire();
+    if (m->numsearches < numworkers) {
+        grid_search **searches = realloc(m->searches, numworkers * sizeof(grid_search *));
+        if (searches == NULL) {
+            printf("Memory allocation failed\n");
+            scheduler_release();
+            return NULL;
+        }
+        memset(searches + m->numsearches, 0, (numworkers - m->numsearches) * sizeof(grid_search *));
+        m->searches = searches;
+        m->numsearches = numworkers;
+    }
+
+    int count = numqueries > 0 ? numqueries : 1;
+    grid_paths *p = calloc(1, sizeof(*p));
+    route_job job = {m, queries, calloc(numworkers, sizeof(cell_buffer)),
+                     malloc(count * sizeof(int)), malloc(count * sizeof(int)), NULL, NULL, NULL,
+                     false};
+    bool ok = p && job.buffers && job.owner && job.where;
+    if (ok) {
+        p->count = numqueries;
+        p->lengths = job.lengths = malloc(count * sizeof(int));
+        p->offsets = job.offsets = malloc((count + 1) * sizeof(int));
+        ok = p->lengths && p->offsets;
+    }
+    if (ok) {
+        parallel_for(0, numqueries, 0, route_queries, &job);
+        ok = !job.failed;
+    }
+    if (ok) {
+        p->offsets[0] = 0;
+        for (int i = 0; i < numqueries; i++) {
+            p->offsets[i + 1] = p->offsets[i] + (p->lengths[i] >= 0 ? p->lengths[i] + 1 : 0);
+        }
+        p->cells = job.cells = malloc((p->offsets[numqueries] > 0 ? p->offsets[numqueries] : 1) *
+                                      sizeof(Node));
+        ok = p->cells != NULL;
+    }
+    if (ok) {
+        parallel_for(0, numqueries, 0, copy_paths, &job);
+    }
+
+    for (int w = 0; job.buffers != NULL && w < numworkers; w++) {
+        free(job.buffers[w].cells);
+    }
+    free(job.buffers);
+    free(job.owner);
+    free(job.where);
+    scheduler_release();
+    if (!ok) {
+        printf("Memory allocation failed\n");
+        destroy_grid_paths(p);
+        return NULL;
+    }
+    return p;
+}
+
+void destroy_grid_paths(grid_paths *p) {
+    if (p != NULL) {
+        free(p->lengths);
+        free(p->offsets);
+        free(p->cells);
+        free(p);
+    }
+}
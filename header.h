@@ -21,12 +21,80 @@ void dfs_visual();
 void printPath();
 void print_path(int *predecessors, int start_node, int end_node);
 
+// ------------------- Grid Engine -------------------
+// A grid loaded once for many path queries. Goals given fields answer
+// queries by walking their flow instead of searching.
+typedef struct {
+    Node goal;
+    int *dist;              // steps from each cell to the goal, INF if cut off
+    unsigned char *flow;    // move toward the goal per cell (up, down, left, right)
+} grid_field;
+
+typedef struct grid_search grid_search;
+
+typedef struct {
+    int rows, cols;
+    unsigned char *open;    // rows * cols, row-major; 0 for walls
+    int *field_at;          // field of each cell as a goal, -1 if none
+    grid_field *fields;
+    int numfields;
+    grid_search **searches; // per-worker BFS scratch, created on demand
+    int numsearches;
+} grid_map;
+
+typedef struct {
+    Node start;
+    Node end;
+} grid_query;
+
+typedef struct {
+    int count;
+    int *lengths;           // steps of each path, -1 when unreachable
+    int *offsets;           // path i is cells[offsets[i] .. offsets[i + 1])
+    Node *cells;
+} grid_paths;
+
+grid_map *create_grid_map(int rows, int cols, const char *cells);
+grid_map *read_grid_map(FILE *in);
+void destroy_grid_map(grid_map *m);
+bool add_grid_fields(grid_map *m, const Node *goals, int numgoals);
+grid_paths *grid_route(grid_map *m, const grid_query *queries, int numqueries);
+void destroy_grid_paths(grid_paths *p);
+
+// ------------------- Allocators -------------------
+// Pluggable memory source for graphs and algorithm scratch. alloc returns
+// zeroed memory; release takes the size that was allocated.
+typedef struct graph_allocator graph_allocator;
+
+struct graph_allocator {
+    void *(*alloc)(graph_allocator *a, size_t size);
+    void (*release)(graph_allocator *a, void *p, size_t size);
+    void (*destroy)(graph_allocator *a);
+    bool releases_in_bulk;      // memory is only reclaimed by destroy_allocator
+};
+
+graph_allocator *heap_allocator(void);
+graph_allocator *create_arena_allocator(size_t chunk_size);
+graph_allocator *create_pool_allocator(void);
+graph_allocator *create_huge_page_allocator(size_t region_size);
+void *allocator_alloc(graph_allocator *a, size_t size);
+void allocator_free(graph_allocator *a, void *p, size_t size);
+void destroy_allocator(graph_allocator *a);
+
 // ------------------- Graph Structures -------------------
 typedef struct mygraph graph;
 
+// Rows of 'edges' may be shared between clones (copy-on-write), so modify
+// edges only through add_edge/remove_edge.
 typedef struct mygraph {
     int numnodes;
     bool **edges;
+    graph_allocator *allocator;
+    // Optional in-edge index (enable_in_index): in_edges[v][u] == edges[u][v].
+    // All three are NULL while the index is off.
+    bool **in_edges;
+    int *in_degree;
+    int *out_degree;
 } graph;
 
 // For Minimum Spanning Tree (Prim's Algorithm)
@@ -39,6 +107,7 @@ typedef struct {
 
 // ------------------- Graph Function Declarations -------------------
 graph *create_graph(int numnodes);
+graph *create_graph_with_allocator(int numnodes, graph_allocator *allocator);
 void destroy_graph(graph *g);
 void print_graph(graph *g);
 bool add_edge(graph *g, unsigned int from_node, unsigned int to_node);
@@ -56,6 +125,7 @@ int get_in_degree(graph *g, unsigned int node);
 int get_out_degree(graph *g, unsigned int node);
 
 edge *get_minimum_spanning_tree(graph *g);
+edge *get_edge_list(graph *g, int *numedges);
 
 bool has_path(graph *g, int start, int end);
 
@@ -63,6 +133,408 @@ bool is_connected(graph *g);
 
 graph* clone_graph(graph *g);
 
+bool enable_in_index(graph *g);
+void disable_in_index(graph *g);
+
+unsigned int next_random(unsigned long long *state);
+
+// ------------------- Compressed Sparse Row -------------------
+// Read-only adjacency-list view of a graph for the algorithm kernels.
+// Neighbors of v are targets[offsets[v] .. offsets[v + 1]), sorted ascending.
+typedef struct {
+    int numnodes;
+    int numedges;
+    int *offsets;
+    int *targets;
+    int *weights;   // parallel to targets, NULL when every edge weighs 1
+} csr_graph;
+
+csr_graph *build_csr(graph *g);
+csr_graph *build_csr_transpose(graph *g);
+csr_graph *build_csr_undirected(graph *g);
+csr_graph *build_csr_from_edges(int numnodes, const edge *edges, int numedges);
+csr_graph *csr_transpose(csr_graph *c);
+void destroy_csr(csr_graph *c);
+
+// ------------------- Scheduler -------------------
+// Library-wide work-stealing thread pool behind every parallel kernel. Loop
+// bodies receive the index (0 .. scheduler_threads()-1) of the worker
+// running them; kernels size per-worker scratch between scheduler_acquire
+// and scheduler_release so the count cannot change under them.
+typedef void (*range_body)(int begin, int end, int worker, void *arg);
+typedef void (*reduce_body)(int begin, int end, int worker, void *accumulator, void *arg);
+typedef void (*reduce_combine)(void *into, const void *from);
+
+bool scheduler_init(int numthreads, bool pin_threads);
+void scheduler_shutdown(void);
+int scheduler_threads(void);
+int scheduler_acquire(void);
+void scheduler_release(void);
+void parallel_for(int begin, int end, int grain, range_body body, void *arg);
+bool parallel_reduce(int begin, int end, int grain, void *result, size_t size,
+                     reduce_body body, reduce_combine combine, void *arg);
+void reduce_sum_double(void *into, const void *from);
+void reduce_sum_long(void *into, const void *from);
+void *alloc_aligned(size_t size);
+void free_aligned(void *p);
+
+// ------------------- Centrality -------------------
+double *pagerank(graph *g, double damping, double tolerance, int max_iterations);
+double *personalized_pagerank(graph *g, int seed, double damping, double tolerance, int max_iterations);
+double *approximate_betweenness(graph *g, int samples, unsigned long long seed);
+
+// ------------------- Local Personalized PageRank -------------------
+// Reusable per-query scratch; results are estimate[v] for v in touched[].
+typedef struct {
+    int numnodes;
+    int numtouched;
+    double *estimate;
+    double *residual;
+    int *touched;
+    bool *is_touched;
+    int *queue;
+    bool *queued;
+} ppr_workspace;
+
+// Scoring used by the friends recommendation system
+typedef enum {
+    RECOMMEND_REACHABLE,    // every reachable non-friend (full Dijkstra)
+    RECOMMEND_PPR_PUSH,     // local forward push
+    RECOMMEND_PPR_WALK      // forward push plus Monte Carlo walks
+} recommend_mode;
+
+ppr_workspace *create_ppr_workspace(int numnodes);
+void destroy_ppr_workspace(ppr_workspace *w);
+int ppr_push(csr_graph *c, int source, double alpha, double epsilon, ppr_workspace *w);
+int ppr_monte_carlo(csr_graph *c, int source, double alpha, int walks,
+                    unsigned long long seed, ppr_workspace *w);
+int ppr_push_walk(csr_graph *c, int source, double alpha, double epsilon, int walks,
+                  unsigned long long seed, ppr_workspace *w);
+int ppr_top_candidates(csr_graph *c, int user, int k, ppr_workspace *w, int *out);
+void recommend_friends_ppr(graph *g, csr_graph **view, ppr_workspace **workspace, int user,
+                           int k, recommend_mode mode);
+
+// ------------------- Triangles and Clustering -------------------
+typedef struct {
+    long long triangles;    // distinct triangles in the undirected view
+    long long *per_node;    // triangles through each node
+    double *clustering;     // local clustering coefficient of each node
+    double transitivity;    // 3 * triangles / wedges
+} triangle_stats;
+
+int sorted_intersection(const int *a, int na, const int *b, int nb, int *out);
+triangle_stats *count_triangles(graph *g);
+triangle_stats *count_triangles_csr(csr_graph *undirected);
+void destroy_triangle_stats(triangle_stats *t);
+
+// ------------------- Community Detection -------------------
+typedef struct {
+    int numnodes;
+    int numcommunities;
+    int *community;         // community id in 0 .. numcommunities-1 per node
+    double modularity;
+} community_result;
+
+community_result *label_propagation(graph *g, int max_iterations, unsigned long long seed);
+community_result *label_propagation_csr(csr_graph *undirected, int max_iterations, unsigned long long seed);
+community_result *louvain(graph *g, int max_levels);
+community_result *louvain_csr(csr_graph *undirected, int max_levels);
+double modularity(csr_graph *undirected, const int *community);
+int connected_components_csr(csr_graph *undirected, int *component);
+void destroy_community_result(community_result *r);
+
+// ------------------- Reordering -------------------
+// Orderings return perm[old_id] = new_id; apply with permute_graph/permute_csr
+// and map results on the relabeled graph back with the unpermute helpers.
+int *order_by_degree(graph *g);
+int *order_hub_cluster(graph *g);
+int *order_rcm(graph *g);
+int *order_gorder(graph *g, int window);
+int *invert_permutation(const int *perm, int n);
+graph *permute_graph(graph *g, const int *perm);
+csr_graph *permute_csr(csr_graph *c, const int *perm);
+void unpermute_values(const int *perm, const int *values, int *out, int n);
+void unpermute_ids(const int *inverse, int *ids, int count);
+void unpermute_predecessors(const int *perm, const int *inverse, const int *predecessors, int *out, int n);
+
+// ------------------- Compressed Adjacency -------------------
+typedef enum {
+    COMPRESS_VARINT,        // gap-encoded LEB128 varints
+    COMPRESS_STREAMVBYTE    // gap-encoded Stream VByte, SIMD decoded
+} compression_scheme;
+
+typedef struct {
+    int numnodes;
+    int numedges;
+    compression_scheme scheme;
+    size_t *offsets;        // byte offset of each node's list in data
+    unsigned char *data;
+    size_t size;
+} compressed_graph;
+
+typedef struct {
+    compression_scheme scheme;
+    int remaining;
+    int index;
+    int current;
+    const unsigned char *control;
+    const unsigned char *data;
+} neighbor_iterator;
+
+compressed_graph *compress_graph(graph *g, compression_scheme scheme);
+compressed_graph *compress_csr(csr_graph *c, compression_scheme scheme);
+void destroy_compressed_graph(compressed_graph *cg);
+size_t compressed_graph_bytes(compressed_graph *cg);
+int compressed_degree(compressed_graph *cg, int node);
+int decode_neighbors(compressed_graph *cg, int node, int *out);
+void neighbors_begin(compressed_graph *cg, int node, neighbor_iterator *it);
+bool neighbors_next(neighbor_iterator *it, int *neighbor);
+int compressed_bfs(compressed_graph *cg, int start, int *distances);
+int compressed_connected_components(compressed_graph *cg, int *component);
+int compressed_recommend(compressed_graph *cg, int user, int *out);
+
+// ------------------- Priority Queue -------------------
+// Indexed min-heap over node ids, keyed by int distance
+typedef struct {
+    int size;
+    int *nodes;     // heap order
+    int *keys;      // key of each node id
+    int *position;  // slot of each node id in nodes, -1 when not queued
+} min_heap;
+
+min_heap *create_min_heap(int numnodes);
+void destroy_min_heap(min_heap *h);
+void heap_clear(min_heap *h);
+bool heap_push(min_heap *h, int node, int key);
+int heap_pop(min_heap *h);
+
+// ------------------- Batched Queries -------------------
+int *batch_bfs(csr_graph *c, const int *sources, int numsources);
+int *batch_dijkstra(csr_graph *c, const int *sources, int numsources);
+int *multi_source_dijkstra(csr_graph *c, const int *sources, int numsources, int *nearest);
+bool batch_recommend(csr_graph *c, const int *users, int numusers, int max_per_user,
+                     int *out, int *counts);
+
+// ------------------- Delta-Stepping -------------------
+int choose_delta(csr_graph *c);
+bool delta_stepping(csr_graph *c, int source, int target, int delta, int *distances,
+                    int *predecessors);
+int *shortest_path_delta_stepping(graph *g, int start_node, int end_node, int **predecessors);
+
+// ------------------- Contraction Hierarchies -------------------
+// Preprocessed shortest-path index. Every arc, shortcut or original, is
+// stored once at its lower-ranked endpoint.
+typedef struct {
+    int numnodes;
+    int *rank;          // contraction order, higher is more important
+    csr_graph *up;      // arcs u->v with rank[v] > rank[u], at u
+    csr_graph *down;    // arcs v->u with rank[v] > rank[u], at u (target v)
+    int *up_middle;     // node bypassed by each up arc, -1 for original edges
+    int *down_middle;
+} ch_index;
+
+typedef struct {
+    int numnodes;
+    int *dist[2];       // forward from the start, backward from the end
+    int *parent[2];
+    min_heap *queue[2];
+    int *touched;
+    int numtouched;
+} ch_workspace;
+
+ch_index *build_ch(csr_graph *c);
+void destroy_ch(ch_index *ch);
+bool save_ch(ch_index *ch, const char *filename);
+ch_index *load_ch(const char *filename);
+ch_workspace *create_ch_workspace(ch_index *ch);
+void destroy_ch_workspace(ch_workspace *ws);
+int ch_query(ch_index *ch, ch_workspace *ws, int start, int end, int *predecessors);
+
+// ------------------- Landmarks (ALT) -------------------
+typedef enum {
+    LANDMARK_FARTHEST,  // each landmark as far as possible from the others
+    LANDMARK_AVOID      // landmarks where current bounds are weakest
+} landmark_strategy;
+
+typedef struct {
+    int numnodes;
+    int numlandmarks;
+    int *landmarks;
+    int *from;          // d(landmark i, v) at [v * numlandmarks + i]
+    int *to;            // d(v, landmark i) at [v * numlandmarks + i]
+} alt_index;
+
+typedef struct {
+    int *dist;
+    int *pred;
+    int *touched;
+    int numtouched;
+    min_heap *queue;
+} alt_workspace;
+
+alt_index *build_alt(csr_graph *c, int numlandmarks, landmark_strategy strategy, unsigned long long seed);
+void destroy_alt(alt_index *alt);
+void alt_bounds(alt_index *alt, int start, int end, int *lower, int *upper);
+alt_workspace *create_alt_workspace(int numnodes);
+void destroy_alt_workspace(alt_workspace *ws);
+int alt_query(alt_index *alt, csr_graph *c, alt_workspace *ws, int start, int end, int *predecessors);
+void degrees_of_separation(graph *g, csr_graph **view, alt_index **index,
+                           alt_workspace **workspace, int from, int to);
+
+// ------------------- Bounded and k-Shortest Paths -------------------
+typedef struct {
+    int node;
+    int parent;         // label this one was reached from, -1 at the source
+    int dist;
+    int hops;
+} path_label;
+
+// Scratch for repeated searches; each search resets only what the previous
+// one touched
+typedef struct {
+    int numnodes;
+    int *dist;          // INF where the last search did not reach
+    int *label;         // best label of each reached node
+    int *touched;
+    int numtouched;
+    int *frontier;
+    unsigned char *blocked;
+    path_label *labels;
+    int numlabels;
+    int labelcapacity;
+    min_heap *queue;
+} search_workspace;
+
+typedef struct {
+    int count;
+    int *lengths;       // total weight of each path
+    int *offsets;       // path i is nodes[offsets[i] .. offsets[i + 1])
+    int *nodes;
+} path_set;
+
+search_workspace *create_search_workspace(int numnodes);
+void destroy_search_workspace(search_workspace *ws);
+int bounded_bfs(csr_graph *c, int source, int max_hops, search_workspace *ws);
+int bounded_dijkstra(csr_graph *c, int source, int target, int max_hops, int max_distance,
+                     search_workspace *ws);
+int search_path(search_workspace *ws, int node, int *path);
+void search_predecessors(search_workspace *ws, int node, int *predecessors);
+path_set *k_shortest_paths(csr_graph *c, int source, int target, int k, search_workspace *ws);
+void destroy_path_set(path_set *p);
+
+// ------------------- Partitioned (Out-of-Core) Processing -------------------
+typedef enum {
+    PARTITION_LDG,      // linear deterministic greedy
+    PARTITION_FENNEL
+} partition_method;
+
+// On-disk shards of an edge list. Shard i holds the out-edges of the nodes
+// placed in it; only per-node arrays live in memory.
+typedef struct {
+    int numnodes;
+    int numshards;
+    long long numedges;
+    int *part;              // shard of each node
+    int *out_degree;
+    long long *shard_edges;
+    int *shard_nodes;
+    char **paths;
+} shard_set;
+
+bool save_edge_list(graph *g, const char *filename);
+shard_set *partition_edge_list(const char *filename, const char *prefix, int numshards,
+                               partition_method method);
+void delete_shards(shard_set *s);
+void destroy_shard_set(shard_set *s);
+int *shard_bfs(shard_set *s, int start);
+int *shard_connected_components(shard_set *s, int *numcomponents);
+double *shard_pagerank(shard_set *s, double damping, double tolerance, int max_iterations);
+
+// ------------------- Maximum Flow -------------------
+typedef enum {
+    FLOW_PUSH_RELABEL,  // highest label with global relabeling and gaps
+    FLOW_DINIC
+} flow_method;
+
+typedef struct {
+    int numnodes;
+    int numedges;
+    long long value;
+    int *flow;          // flow on each input edge, same order as the input
+    bool *source_side;  // minimum cut: nodes on the source's side
+} flow_result;
+
+flow_result *max_flow(int numnodes, const edge *edges, int numedges, int source, int sink,
+                      flow_method method);
+void destroy_flow_result(flow_result *f);
+
+// ------------------- Matching and Coloring -------------------
+typedef struct {
+    int numnodes;
+    int size;           // number of matched pairs
+    int *mate;          // partner of each node, -1 when unmatched
+} matching_result;
+
+matching_result *hopcroft_karp(graph *g, const bool *left);
+matching_result *hopcroft_karp_csr(csr_graph *undirected, const bool *left);
+void destroy_matching_result(matching_result *m);
+
+typedef enum {
+    COLOR_GREEDY,           // sequential first fit
+    COLOR_SPECULATIVE,      // parallel first fit with conflict recoloring
+    COLOR_JONES_PLASSMANN   // parallel rounds of locally highest priority nodes
+} coloring_method;
+
+typedef enum {
+    ORDER_NATURAL,
+    ORDER_RANDOM,
+    ORDER_LARGEST_FIRST,
+    ORDER_SMALLEST_LAST     // degeneracy order
+} coloring_order;
+
+typedef struct {
+    int numnodes;
+    int numcolors;
+    int *color;             // color in 0 .. numcolors-1 per node
+} coloring_result;
+
+coloring_result *color_graph(graph *g, coloring_method method, coloring_order ordering,
+                             unsigned long long seed);
+coloring_result *color_graph_csr(csr_graph *undirected, coloring_method method,
+                                 coloring_order ordering, unsigned long long seed);
+bool is_valid_coloring(csr_graph *undirected, const int *color);
+void destroy_coloring_result(coloring_result *r);
+
+// ------------------- Specialized Kernels -------------------
+// One traversal API over every representation. Each call picks a kernel
+// compiled for the exact (representation, weight type, direction) once,
+// so inner loops carry no representation or weight checks.
+typedef enum {
+    REPR_MATRIX,
+    REPR_CSR,           // unit weights when weights is NULL
+    REPR_COMPRESSED     // unit weights
+} graph_repr;
+
+typedef struct {
+    graph_repr repr;
+    bool directed;
+    int numnodes;
+    graph *matrix;
+    csr_graph *csr;
+    compressed_graph *compressed;
+    // Reverse lists walked by undirected sparse views, owned by the view
+    csr_graph *csr_reverse;
+    compressed_graph *compressed_reverse;
+} graph_view;
+
+graph_view *create_graph_view(graph *g, bool directed);
+graph_view *create_csr_view(csr_graph *c, bool directed);
+graph_view *create_compressed_view(compressed_graph *cg, bool directed);
+void destroy_graph_view(graph_view *v);
+int view_bfs(graph_view *v, int source, int *distances, int *order);
+bool view_dijkstra(graph_view *v, int source, int target, int *distances, int *predecessors);
+int view_spanning_forest(graph_view *v, int *parent, int *weight);
+
 
 //########################## Menu Functions start from here #################################
 void show_graph_menu();
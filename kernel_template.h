@@ -0,0 +1,266 @@
+// Algorithm kernels instantiated once per graph representation, weight type
+// and direction. Not a normal header: kernels.c defines the parameters below
+// and includes this file once per combination, so every inner loop is
+// compiled against concrete types with no per-arc switches or calls.
+//
+//   KERNEL(name)        mangles the kernel names for this instantiation
+//
+// Dense (adjacency matrix) instantiations define KERNEL_DENSE and
+//   KERNEL_ARC(row, rev, rows, u, v)  nonzero when u reaches v; 'row' is
+//                       rows[u] and 'rev' the in-edge row of u
+//
+// Sparse instantiations define
+//   KERNEL_GRAPH        the list type (csr_graph, compressed_graph)
+//   KERNEL_SIDES        1 walks out-lists, 2 also walks the reverse lists
+//   KERNEL_ROW(g, u, nbrs, wts, deg, buf)  points nbrs/wts at u's list
+//   KERNEL_WEIGHT(wts, k)  weight of the k-th arc of the list
+
+#ifdef KERNEL_DENSE
+
+// Queue-order BFS over a bool matrix. Each row is first folded into a byte
+// mask of newly reached columns in one vectorized pass; the queue append
+// then skips empty 8-column words. 'fresh' and 'seen' hold n rounded up to
+// a multiple of 8, zeroed.
+static int KERNEL(bfs)(bool **rows, bool **reverse, int n, int source, int *dist, int *order,
+                       unsigned char *fresh, unsigned char *seen) {
+    for (int v = 0; v < n; v++) {
+        dist[v] = INF;
+    }
+    int head = 0, tail = 0;
+    dist[source] = 0;
+    seen[source] = 1;
+    order[tail++] = source;
+    while (head < tail) {
+        int u = order[head++];
+        const unsigned char *row = (const unsigned char *)rows[u];
+        const unsigned char *rev = (const unsigned char *)reverse[u];
+        #pragma omp simd
+        for (int v = 0; v < n; v++) {
+            unsigned char reached = KERNEL_ARC(row, rev, rows, u, v) & ~seen[v];
+            fresh[v] = reached;
+            seen[v] |= reached;
+        }
+        (void)rev;
+
+        int next = dist[u] + 1;
+        for (int w = 0; w < n; w += 8) {
+            uint64_t word;
+            memcpy(&word, fresh + w, sizeof(word));
+            if (word == 0) {
+                continue;
+            }
+            int end = w + 8 < n ? w + 8 : n;
+            for (int v = w; v < end; v++) {
+                dist[v] = fresh[v] ? next : dist[v];
+                order[tail] = v;
+                tail += fresh[v];
+            }
+        }
+    }
+    return tail;
+}
+
+// Array-scan Dijkstra on unit weights, O(n^2) like the matrix it walks.
+// The minimum is a vectorized reduction followed by a scan for its first
+// holder, so ties go to the lowest node id as in the original.
+static void KERNEL(dijkstra)(bool **rows, bool **reverse, int n, int source, int target,
+                             int *dist, int *pred, unsigned char *done) {
+    for (int v = 0; v < n; v++) {
+        dist[v] = INF;
+        pred[v] = -1;
+        done[v] = 0;
+    }
+    dist[source] = 0;
+
+    for (int i = 0; i < n; i++) {
+        int best = INF;
+        #pragma omp simd reduction(min:best)
+        for (int v = 0; v < n; v++) {
+            int d = dist[v];
+            int key = done[v] ? INF : d;
+            best = key < best ? key : best;
+        }
+        if (best == INF) {
+            break;
+        }
+        int u = 0;
+        while (done[u] || dist[u] != best) {
+            u++;
+        }
+        if (u == target) {
+            break;
+        }
+        done[u] = 1;
+
+        const unsigned char *row = (const unsigned char *)rows[u];
+        const unsigned char *rev = (const unsigned char *)reverse[u];
+        int cand = best + 1;
+        #pragma omp simd
+        for (int v = 0; v < n; v++) {
+            int d = dist[v], p = pred[v];
+            int better = KERNEL_ARC(row, rev, rows, u, v) & (!done[v]) & (cand < d);
+            dist[v] = better ? cand : d;
+            pred[v] = better ? u : p;
+        }
+        (void)rev;
+    }
+}
+
+// Prim's algorithm with array scans; starts a new tree at the lowest
+// unreached node whenever the current one is exhausted
+static int KERNEL(prim)(bool **rows, bool **reverse, int n, int *parent, int *key,
+                        unsigned char *done) {
+    for (int v = 0; v < n; v++) {
+        key[v] = INF;
+        parent[v] = -1;
+        done[v] = 0;
+    }
+    int treeedges = 0;
+    for (int i = 0; i < n; i++) {
+        int best = INF;
+        #pragma omp simd reduction(min:best)
+        for (int v = 0; v < n; v++) {
+            int kv = key[v];
+            int k = done[v] ? INF : kv;
+            best = k < best ? k : best;
+        }
+        int u = 0;
+        while (done[u] || (best != INF && key[u] != best)) {
+            u++;
+        }
+        done[u] = 1;
+        treeedges += parent[u] >= 0;
+
+        const unsigned char *row = (const unsigned char *)rows[u];
+        const unsigned char *rev = (const unsigned char *)reverse[u];
+        #pragma omp simd
+        for (int v = 0; v < n; v++) {
+            int kv = key[v], p = parent[v];
+            int better = KERNEL_ARC(row, rev, rows, u, v) & (!done[v]) & (1 < kv);
+            key[v] = better ? 1 : kv;
+            parent[v] = better ? u : p;
+        }
+        (void)rev;
+    }
+    return treeedges;
+}
+
+#else
+
+// Queue-order BFS; 'order' needs n + 1 slots for the branch-free append
+static int KERNEL(bfs)(KERNEL_GRAPH *forward, KERNEL_GRAPH *reverse, int n, int source,
+                       int *dist, int *order, int *buf) {
+    KERNEL_GRAPH *sides[2] = {forward, reverse};
+    for (int v = 0; v < n; v++) {
+        dist[v] = INF;
+    }
+    int head = 0, tail = 0;
+    dist[source] = 0;
+    order[tail++] = source;
+    while (head < tail) {
+        int u = order[head++];
+        int next = dist[u] + 1;
+        for (int s = 0; s < KERNEL_SIDES; s++) {
+            const int *nbrs;
+            const int *wts;
+            int deg;
+            KERNEL_ROW(sides[s], u, nbrs, wts, deg, buf);
+            (void)wts;
+            for (int k = 0; k < deg; k++) {
+                int v = nbrs[k];
+                int fresh = dist[v] == INF;
+                dist[v] = fresh ? next : dist[v];
+                order[tail] = v;
+                tail += fresh;
+            }
+        }
+    }
+    return tail;
+}
+
+static void KERNEL(dijkstra)(KERNEL_GRAPH *forward, KERNEL_GRAPH *reverse, int n, int source,
+                             int target, int *dist, int *pred, min_heap *h, int *buf) {
+    KERNEL_GRAPH *sides[2] = {forward, reverse};
+    for (int v = 0; v < n; v++) {
+        dist[v] = INF;
+        pred[v] = -1;
+    }
+    heap_clear(h);
+    dist[source] = 0;
+    heap_push(h, source, 0);
+
+    while (h->size > 0) {
+        int u = heap_pop(h);
+        if (u == target) {
+            break;
+        }
+        int du = dist[u];
+        for (int s = 0; s < KERNEL_SIDES; s++) {
+            const int *nbrs;
+            const int *wts;
+            int deg;
+            KERNEL_ROW(sides[s], u, nbrs, wts, deg, buf);
+            (void)wts;
+            for (int k = 0; k < deg; k++) {
+                int v = nbrs[k];
+                int alt = du + KERNEL_WEIGHT(wts, k);
+                if (alt < dist[v]) {
+                    dist[v] = alt;
+                    pred[v] = u;
+                    heap_push(h, v, alt);
+                }
+            }
+        }
+    }
+}
+
+static int KERNEL(prim)(KERNEL_GRAPH *forward, KERNEL_GRAPH *reverse, int n, int *parent,
+                        int *key, unsigned char *done, min_heap *h, int *buf) {
+    KERNEL_GRAPH *sides[2] = {forward, reverse};
+    for (int v = 0; v < n; v++) {
+        key[v] = INF;
+        parent[v] = -1;
+        done[v] = 0;
+    }
+    heap_clear(h);
+    int treeedges = 0;
+    for (int root = 0; root < n; root++) {
+        if (done[root]) {
+            continue;
+        }
+        key[root] = 0;
+        heap_push(h, root, 0);
+        while (h->size > 0) {
+            int u = heap_pop(h);
+            done[u] = 1;
+            treeedges += parent[u] >= 0;
+            for (int s = 0; s < KERNEL_SIDES; s++) {
+                const int *nbrs;
+                const int *wts;
+                int deg;
+                KERNEL_ROW(sides[s], u, nbrs, wts, deg, buf);
+                (void)wts;
+                for (int k = 0; k < deg; k++) {
+                    int v = nbrs[k];
+                    int w = KERNEL_WEIGHT(wts, k);
+                    if (!done[v] && w < key[v]) {
+                        key[v] = w;
+                        parent[v] = u;
+                        heap_push(h, v, w);
+                    }
+                }
+            }
+        }
+    }
+    return treeedges;
+}
+
+#endif
+
+#undef KERNEL
+#undef KERNEL_DENSE
+#undef KERNEL_ARC
+#undef KERNEL_GRAPH
+#undef KERNEL_SIDES
+#undef KERNEL_ROW
+#undef KERNEL_WEIGHT
@@ -0,0 +1,413 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+#include "header.h"
+
+// ------------------- Kernel instantiations -------------------
+// One copy of each kernel per (representation, weight type, direction);
+// see kernel_template.h for the parameters.
+
+#define CSR_UNIT_ROW(g, u, nbrs, wts, deg, buf) \
+    ((nbrs) = (g)->targets + (g)->offsets[u], (wts) = NULL, \
+     (deg) = (g)->offsets[(u) + 1] - (g)->offsets[u])
+#define CSR_WEIGHTED_ROW(g, u, nbrs, wts, deg, buf) \
+    ((nbrs) = (g)->targets + (g)->offsets[u], (wts) = (g)->weights + (g)->offsets[u], \
+     (deg) = (g)->offsets[(u) + 1] - (g)->offsets[u])
+#define COMPRESSED_ROW(g, u, nbrs, wts, deg, buf) \
+    ((deg) = decode_neighbors(g, u, buf), (nbrs) = (buf), (wts) = NULL)
+
+// Matrix, out-edges only
+#define KERNEL_DENSE
+#define KERNEL(name) name##_matrix_directed
+#define KERNEL_ARC(row, rev, rows, u, v) (row)[v]
+#include "kernel_template.h"
+
+// Matrix, undirected through the in-edge index: two contiguous rows
+#define KERNEL_DENSE
+#define KERNEL(name) name##_matrix_indexed
+#define KERNEL_ARC(row, rev, rows, u, v) ((row)[v] | (rev)[v])
+#include "kernel_template.h"
+
+// Matrix, undirected without the index: the reverse is a column read
+#define KERNEL_DENSE
+#define KERNEL(name) name##_matrix_columns
+#define KERNEL_ARC(row, rev, rows, u, v) ((row)[v] | (rows)[v][u])
+#include "kernel_template.h"
+
+#define KERNEL(name) name##_csr_unit_directed
+#define KERNEL_GRAPH csr_graph
+#define KERNEL_SIDES 1
+#define KERNEL_ROW CSR_UNIT_ROW
+#define KERNEL_WEIGHT(wts, k) 1
+#include "kernel_template.h"
+
+#define KERNEL(name) name##_csr_unit_undirected
+#define KERNEL_GRAPH csr_graph
+#define KERNEL_SIDES 2
+#define KERNEL_ROW CSR_UNIT_ROW
+#define KERNEL_WEIGHT(wts, k) 1
+#include "kernel_template.h"
+
+#define KERNEL(name) name##_csr_weighted_directed
+#define KERNEL_GRAPH csr_graph
+#define KERNEL_SIDES 1
+#define KERNEL_ROW CSR_WEIGHTED_ROW
+#define KERNEL_WEIGHT(wts, k) (wts)[k]
+#include "kernel_template.h"
+
+#define KERNEL(name) name##_csr_weighted_undirected
+#define KERNEL_GRAPH csr_graph
+#define KERNEL_SIDES 2
+#define KERNEL_ROW CSR_WEIGHTED_ROW
+#define KERNEL_WEIGHT(wts, k) (wts)[k]
+#include "kernel_template.h"
+
+#define KERNEL(name) name##_compressed_directed
+#define KERNEL_GRAPH compressed_graph
+#define KERNEL_SIDES 1
+#define KERNEL_ROW COMPRESSED_ROW
+#define KERNEL_WEIGHT(wts, k) 1
+#include "kernel_template.h"
+
+#define KERNEL(name) name##_compressed_undirected
+#define KERNEL_GRAPH compressed_graph
+#define KERNEL_SIDES 2
+#define KERNEL_ROW COMPRESSED_ROW
+#define KERNEL_WEIGHT(wts, k) 1
+#include "kernel_template.h"
+
+// ------------------- Dispatch -------------------
+typedef enum {
+    MATRIX_DIRECTED,
+    MATRIX_INDEXED,
+    MATRIX_COLUMNS,
+    CSR_UNIT_DIRECTED,
+    CSR_UNIT_UNDIRECTED,
+    CSR_WEIGHTED_DIRECTED,
+    CSR_WEIGHTED_UNDIRECTED,
+    COMPRESSED_DIRECTED,
+    COMPRESSED_UNDIRECTED
+} kernel_variant;
+
+// The single runtime decision per call. The in-edge index is looked up
+// here rather than at view creation since it can be toggled at any time.
+static kernel_variant variant_of(graph_view *v) {
+    switch (v->repr) {
+        case REPR_MATRIX:
+            if (v->directed) {
+                return MATRIX_DIRECTED;
+            }
+            return v->matrix->in_edges ? MATRIX_INDEXED : MATRIX_COLUMNS;
+        case REPR_CSR:
+            if (v->csr->weights) {
+                return v->directed ? CSR_WEIGHTED_DIRECTED : CSR_WEIGHTED_UNDIRECTED;
+            }
+            return v->directed ? CSR_UNIT_DIRECTED : CSR_UNIT_UNDIRECTED;
+        case REPR_COMPRESSED:
+        default:
+            return v->directed ? COMPRESSED_DIRECTED : COMPRESSED_UNDIRECTED;
+    }
+}
+
+// Scratch for matrix views comes from the graph's allocator
+static void *view_alloc(graph_view *v, size_t size) {
+    return allocator_alloc(v->repr == REPR_MATRIX ? v->matrix->allocator : NULL, size);
+}
+
+static void view_free(graph_view *v, void *p, size_t size) {
+    allocator_free(v->repr == REPR_MATRIX ? v->matrix->allocator : NULL, p, size);
+}
+
+static graph_view *new_view(graph_repr repr, int numnodes, bool directed) {
+    graph_view *v = calloc(1, sizeof(*v));
+    if (v == NULL) {
+        printf("Memory allocation failed\n");
+        return NULL;
+    }
+    v->repr = repr;
+    v->numnodes = numnodes;
+    v->directed = directed;
+    return v;
+}
+
+// Views over an existing graph; the graph must outlive the view. An
+// undirected view follows edges both ways.
+graph_view *create_graph_view(graph *g, bool directed) {
+    assert(g != NULL);
+    graph_view *v = new_view(REPR_MATRIX, g->numnodes, directed);
+    if (v != NULL) {
+        v->matrix = g;
+    }
+    return v;
+}
+
+// Undirected sparse views keep a transposed copy for the reverse lists
+graph_view *create_csr_view(csr_graph *c, bool directed) {
+    assert(c != NULL);
+    graph_view *v = new_view(REPR_CSR, c->numnodes, directed);
+    if (v == NULL) {
+        return NULL;
+    }
+    v->csr = c;
+    if (!directed && (v->csr_reverse = csr_transpose(c)) == NULL) {
+        printf("Memory allocation failed\n");
+        free(v);
+        return NULL;
+    }
+    return v;
+}
+
+graph_view *create_compressed_view(compressed_graph *cg, bool directed) {
+    assert(cg != NULL);
+    graph_view *v = new_view(REPR_COMPRESSED, cg->numnodes, directed);
+    if (v == NULL) {
+        return NULL;
+    }
+    v->compressed = cg;
+    if (directed) {
+        return v;
+    }
+
+    // Decode every list as reversed edges and recompress them
+    int n = cg->numnodes;
+    edge *edges = malloc((cg->numedges > 0 ? cg->numedges : 1) * sizeof(edge));
+    int *buf = malloc((n > 0 ? n : 1) * sizeof(int));
+    csr_graph *reverse = NULL;
+    if (edges != NULL && buf != NULL) {
+        int m = 0;
+        for (int u = 0; u < n; u++) {
+            int deg = decode_neighbors(cg, u, buf);
+            for (int k = 0; k < deg; k++) {
+                edges[m].from = buf[k];
+                edges[m].to = u;
+                edges[m].weight = 1;
+                m++;
+            }
+        }
+        reverse = build_csr_from_edges(n, edges, m);
+    }
+    if (reverse != NULL) {
+        v->compressed_reverse = compress_csr(reverse, cg->scheme);
+    }
+    free(edges);
+    free(buf);
+    destroy_csr(reverse);
+    if (v->compressed_reverse == NULL) {
+        printf("Memory allocation failed\n");
+        free(v);
+        return NULL;
+    }
+    return v;
+}
+
+void destroy_graph_view(graph_view *v) {
+    if (v != NULL) {
+        destroy_csr(v->csr_reverse);
+        destroy_compressed_graph(v->compressed_reverse);
+        free(v);
+    }
+}
+
+// BFS from 'source': distances[] gets hop counts (INF if unreachable) and
+// 'order' (optional, n slots) the visit sequence. Returns nodes reached.
+int view_bfs(graph_view *v, int source, int *distances, int *order) {
+    assert(v != NULL && distances != NULL);
+    assert(source >= 0 && source < v->numnodes);
+    int n = v->numnodes;
+    // Matrix kernels take two byte masks, sparse ones a decode buffer
+    size_t padded = (size_t)(n + 7) / 8 * 8;
+    size_t bufsize = v->repr == REPR_MATRIX ? 2 * padded : (size_t)(n > 0 ? n : 1) * sizeof(int);
+    int *queue = view_alloc(v, (n + 1) * sizeof(int));
+    void *buf = view_alloc(v, bufsize);
+    if (queue == NULL || buf == NULL) {
+        printf("Memory allocation failed\n");
+        view_free(v, buf, bufsize);
+        view_free(v, queue, (n + 1) * sizeof(int));
+        return 0;
+    }
+
+    graph *g = v->matrix;
+    int reached = 0;
+    switch (variant_of(v)) {
+        case MATRIX_DIRECTED:
+            reached = bfs_matrix_directed(g->edges, g->edges, n, source, distances, queue,
+                                          buf, (unsigned char *)buf + padded);
+            break;
+        case MATRIX_INDEXED:
+            reached = bfs_matrix_indexed(g->edges, g->in_edges, n, source, distances, queue,
+                                         buf, (unsigned char *)buf + padded);
+            break;
+        case MATRIX_COLUMNS:
+            reached = bfs_matrix_columns(g->edges, g->edges, n, source, distances, queue,
+                                         buf, (unsigned char *)buf + padded);
+            break;
+        case CSR_UNIT_DIRECTED:
+            reached = bfs_csr_unit_directed(v->csr, NULL, n, source, distances, queue, buf);
+            break;
+        case CSR_UNIT_UNDIRECTED:
+            reached = bfs_csr_unit_undirected(v->csr, v->csr_reverse, n, source, distances,
+                                              queue, buf);
+            break;
+        case CSR_WEIGHTED_DIRECTED:
+            reached = bfs_csr_weighted_directed(v->csr, NULL, n, source, distances, queue, buf);
+            break;
+        case CSR_WEIGHTED_UNDIRECTED:
+            reached = bfs_csr_weighted_undirected(v->csr, v->csr_reverse, n, source, distances,
+                                                  queue, buf);
+            break;
+        case COMPRESSED_DIRECTED:
+            reached = bfs_compressed_directed(v->compressed, NULL, n, source, distances, queue,
+                                              buf);
+            break;
+        case COMPRESSED_UNDIRECTED:
+            reached = bfs_compressed_undirected(v->compressed, v->compressed_reverse, n, source,
+                                                distances, queue, buf);
+            break;
+    }
+    for (int i = 0; order != NULL && i < reached; i++) {
+        order[i] = queue[i];
+    }
+    view_free(v, buf, bufsize);
+    view_free(v, queue, (n + 1) * sizeof(int));
+    return reached;
+}
+
+// Shortest distances from 'source', stopping once 'target' is settled
+// (-1 settles everything). predecessors[] gets the shortest path tree.
+bool view_dijkstra(graph_view *v, int source, int target, int *distances, int *predecessors) {
+    assert(v != NULL && distances != NULL && predecessors != NULL);
+    assert(source >= 0 && source < v->numnodes);
+    int n = v->numnodes;
+    graph *g = v->matrix;
+    kernel_variant variant = variant_of(v);
+
+    if (v->repr == REPR_MATRIX) {
+        unsigned char *done = view_alloc(v, n > 0 ? n : 1);
+        if (done == NULL) {
+            printf("Memory allocation failed\n");
+            return false;
+        }
+        if (variant == MATRIX_DIRECTED) {
+            dijkstra_matrix_directed(g->edges, g->edges, n, source, target, distances,
+                                     predecessors, done);
+        } else if (variant == MATRIX_INDEXED) {
+            dijkstra_matrix_indexed(g->edges, g->in_edges, n, source, target, distances,
+                                    predecessors, done);
+        } else {
+            dijkstra_matrix_columns(g->edges, g->edges, n, source, target, distances,
+                                    predecessors, done);
+        }
+        view_free(v, done, n > 0 ? n : 1);
+        return true;
+    }
+
+    min_heap *h = create_min_heap(n);
+    int *buf = v->repr == REPR_COMPRESSED ? malloc((n > 0 ? n : 1) * sizeof(int)) : NULL;
+    if (h == NULL || (v->repr == REPR_COMPRESSED && buf == NULL)) {
+        printf("Memory allocation failed\n");
+        destroy_min_heap(h);
+        free(buf);
+        return false;
+    }
+    switch (variant) {
+        case CSR_UNIT_DIRECTED:
+            dijkstra_csr_unit_directed(v->csr, NULL, n, source, target, distances,
+                                       predecessors, h, buf);
+            break;
+        case CSR_UNIT_UNDIRECTED:
+            dijkstra_csr_unit_undirected(v->csr, v->csr_reverse, n, source, target, distances,
+                                         predecessors, h, buf);
+            break;
+        case CSR_WEIGHTED_DIRECTED:
+            dijkstra_csr_weighted_directed(v->csr, NULL, n, source, target, distances,
+                                           predecessors, h, buf);
+            break;
+        case CSR_WEIGHTED_UNDIRECTED:
+            dijkstra_csr_weighted_undirected(v->csr, v->csr_reverse, n, source, target,
+                                             distances, predecessors, h, buf);
+            break;
+        case COMPRESSED_DIRECTED:
+            dijkstra_compressed_directed(v->compressed, NULL, n, source, target, distances,
+                                         predecessors, h, buf);
+            break;
+        case COMPRESSED_UNDIRECTED:
+            dijkstra_compressed_undirected(v->compressed, v->compressed_reverse, n, source,
+                                           target, distances, predecessors, h, buf);
+            break;
+        default:
+            break;
+    }
+    destroy_min_heap(h);
+    free(buf);
+    return true;
+}
+
+// Minimum spanning forest by Prim's algorithm, one tree per part reached
+// from the lowest unvisited node. parent[v] is -1 for roots; otherwise
+// weight[v] is the weight of the edge to the parent. Returns the number of tree edges,
+// -1 on allocation failure. Directed views only grow trees along out-edges.
+int view_spanning_forest(graph_view *v, int *parent, int *weight) {
+    assert(v != NULL && parent != NULL && weight != NULL);
+    int n = v->numnodes;
+    graph *g = v->matrix;
+    kernel_variant variant = variant_of(v);
+    unsigned char *done = view_alloc(v, n > 0 ? n : 1);
+    if (done == NULL) {
+        printf("Memory allocation failed\n");
+        return -1;
+    }
+
+    int treeedges = -1;
+    if (v->repr == REPR_MATRIX) {
+        if (variant == MATRIX_DIRECTED) {
+            treeedges = prim_matrix_directed(g->edges, g->edges, n, parent, weight, done);
+        } else if (variant == MATRIX_INDEXED) {
+            treeedges = prim_matrix_indexed(g->edges, g->in_edges, n, parent, weight, done);
+        } else {
+            treeedges = prim_matrix_columns(g->edges, g->edges, n, parent, weight, done);
+        }
+        view_free(v, done, n > 0 ? n : 1);
+        return treeedges;
+    }
+
+    min_heap *h = create_min_heap(n);
+    int *buf = v->repr == REPR_COMPRESSED ? malloc((n > 0 ? n : 1) * sizeof(int)) : NULL;
+    if (h != NULL && (v->repr != REPR_COMPRESSED || buf != NULL)) {
+        switch (variant) {
+            case CSR_UNIT_DIRECTED:
+                treeedges = prim_csr_unit_directed(v->csr, NULL, n, parent, weight, done, h,
+                                                   buf);
+                break;
+            case CSR_UNIT_UNDIRECTED:
+                treeedges = prim_csr_unit_undirected(v->csr, v->csr_reverse, n, parent, weight,
+                                                     done, h, buf);
+                break;
+            case CSR_WEIGHTED_DIRECTED:
+                treeedges = prim_csr_weighted_directed(v->csr, NULL, n, parent, weight, done, h,
+                                                       buf);
+                break;
+            case CSR_WEIGHTED_UNDIRECTED:
+                treeedges = prim_csr_weighted_undirected(v->csr, v->csr_reverse, n, parent,
+                                                         weight, done, h, buf);
+                break;
+            case COMPRESSED_DIRECTED:
+                treeedges = prim_compressed_directed(v->compressed, NULL, n, parent, weight,
+                                                     done, h, buf);
+                break;
+            case COMPRESSED_UNDIRECTED:
+                treeedges = prim_compressed_undirected(v->compressed, v->compressed_reverse, n,
+                                                       parent, weight, done, h, buf);
+                break;
+            default:
+                break;
+        }
+    } else {
+        printf("Memory allocation failed\n");
+    }
+    destroy_min_heap(h);
+    free(buf);
+    view_free(v, done, n > 0 ? n : 1);
+    return treeedges;
+}
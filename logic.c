@@ -3,25 +3,146 @@
 #include <string.h>
 #include<assert.h>
 #include<limits.h>
+#include <stdatomic.h>
 #include "header.h"
 
+// Every matrix row carries a reference count so clones can share rows and
+// copy one only when it is written (copy-on-write). edges[i] points just
+// past the header.
+typedef struct {
+    atomic_int refs;
+    int pad[3];     // keeps the row data 16-byte aligned
+} row_header;
+
+static row_header *row_of(bool *row) {
+    return (row_header *)row - 1;
+}
+
+static bool *alloc_row(graph_allocator *allocator, int numnodes) {
+    row_header *h = allocator_alloc(allocator, sizeof(row_header) + numnodes * sizeof(bool));
+    if (h == NULL) {
+        return NULL;
+    }
+    atomic_init(&h->refs, 1);
+    return (bool *)(h + 1);
+}
+
+// Drop one reference; the last owner frees the row
+static void release_row(graph_allocator *allocator, bool *row, int numnodes) {
+    if (row != NULL && atomic_fetch_sub(&row_of(row)->refs, 1) == 1) {
+        allocator_free(allocator, row_of(row), sizeof(row_header) + numnodes * sizeof(bool));
+    }
+}
+
+// Give 'g' its own copy of rows[i] (a row of edges or in_edges) before it
+// is modified
+static bool make_row_private(graph *g, bool **rows, int i) {
+    bool *row = rows[i];
+    if (atomic_load(&row_of(row)->refs) == 1) {
+        return true;
+    }
+    bool *copy = alloc_row(g->allocator, g->numnodes);
+    if (copy == NULL) {
+        return false;
+    }
+    memcpy(copy, row, g->numnodes * sizeof(bool));
+    rows[i] = copy;
+    release_row(g->allocator, row, g->numnodes);
+    return true;
+}
+
+// Row pointer array sharing every row of 'rows' (NULL rows array -> NULL)
+static bool **share_rows(graph_allocator *allocator, bool **rows, int numnodes) {
+    bool **shared = allocator_alloc(allocator, numnodes * sizeof(bool *));
+    if (shared == NULL) {
+        return NULL;
+    }
+    for (int i = 0; i < numnodes; i++) {
+        atomic_fetch_add(&row_of(rows[i])->refs, 1);
+        shared[i] = rows[i];
+    }
+    return shared;
+}
+
+static void release_rows(graph_allocator *allocator, bool **rows, int numnodes) {
+    if (rows != NULL) {
+        for (int i = numnodes - 1; i >= 0; i--) {
+            release_row(allocator, rows[i], numnodes);
+        }
+        allocator_free(allocator, rows, numnodes * sizeof(bool *));
+    }
+}
+
+static int *copy_degrees(graph_allocator *allocator, const int *degrees, int numnodes) {
+    int *copy = allocator_alloc(allocator, numnodes * sizeof(int));
+    if (copy != NULL) {
+        memcpy(copy, degrees, numnodes * sizeof(int));
+    }
+    return copy;
+}
+
+// New graph sharing all rows of 'g' (copy-on-write). With 'flip' the roles
+// of edges and in_edges are swapped, which is exactly the transpose.
+static graph *share_graph(graph *g, bool flip) {
+    graph_allocator *allocator = g->allocator;
+    int n = g->numnodes;
+    graph *shared = allocator_alloc(allocator, sizeof(*shared));
+    if (shared == NULL) {
+        return NULL;
+    }
+    shared->numnodes = n;
+    shared->allocator = allocator;
+    shared->edges = share_rows(allocator, flip ? g->in_edges : g->edges, n);
+    shared->in_edges = NULL;
+    shared->in_degree = NULL;
+    shared->out_degree = NULL;
+    if (shared->edges == NULL) {
+        allocator_free(allocator, shared, sizeof(*shared));
+        return NULL;
+    }
+
+    if (g->in_edges != NULL) {
+        shared->in_edges = share_rows(allocator, flip ? g->edges : g->in_edges, n);
+        shared->in_degree = copy_degrees(allocator, flip ? g->out_degree : g->in_degree, n);
+        shared->out_degree = copy_degrees(allocator, flip ? g->in_degree : g->out_degree, n);
+        if (!shared->in_edges || !shared->in_degree || !shared->out_degree) {
+            destroy_graph(shared);
+            return NULL;
+        }
+    }
+    return shared;
+}
+
 // Create a new graph with 'numnodes' nodes
 graph *create_graph(int numnodes) {
-    graph *g = malloc(sizeof(*g));
+    return create_graph_with_allocator(numnodes, NULL);
+}
+
+// Create a graph whose matrix, clones, transposes and algorithm scratch all
+// come from 'allocator' (the heap when NULL)
+graph *create_graph_with_allocator(int numnodes, graph_allocator *allocator) {
+    if (allocator == NULL) {
+        allocator = heap_allocator();
+    }
+    graph *g = allocator_alloc(allocator, sizeof(*g));
     if (g == NULL) {
         return NULL;
     }
     g->numnodes = numnodes;
+    g->allocator = allocator;
+    g->in_edges = NULL;
+    g->in_degree = NULL;
+    g->out_degree = NULL;
 
     // Allocate memory for the edges matrix
-    g->edges = calloc(g->numnodes, sizeof(bool *));
+    g->edges = allocator_alloc(allocator, g->numnodes * sizeof(bool *));
     if (g->edges == NULL) {
-        free(g);
+        allocator_free(allocator, g, sizeof(*g));
         return NULL;
     }
 
     for (int i = 0; i < g->numnodes; i++) {
-        g->edges[i] = calloc(g->numnodes, sizeof(bool));
+        g->edges[i] = alloc_row(allocator, g->numnodes);
         if (g->edges[i] == NULL) {
             destroy_graph(g);
             return NULL;
@@ -31,17 +152,81 @@ graph *create_graph(int numnodes) {
     return g;
 }
 
-// Destroy a graph and free all allocated memory
+// Destroy a graph and free all allocated memory. Graphs living in an arena
+// are left for destroy_allocator to reclaim in one go.
 void destroy_graph(graph* g) {
     if (g != NULL) {
-        if (g->edges != NULL) {
-            for (int i = 0; i < g->numnodes; i++) {
-                free(g->edges[i]);
+        graph_allocator *allocator = g->allocator;
+        if (allocator->releases_in_bulk) {
+            return;
+        }
+        disable_in_index(g);
+        release_rows(allocator, g->edges, g->numnodes);
+        allocator_free(allocator, g, sizeof(*g));
+    }
+}
+
+// Scratch buffers for the algorithms below come from the graph's allocator.
+// They are freed in reverse order so an arena can take them back.
+static void *scratch_alloc(graph *g, size_t size) {
+    return allocator_alloc(g->allocator, size);
+}
+
+static void scratch_free(graph *g, void *p, size_t size) {
+    allocator_free(g->allocator, p, size);
+}
+
+// Maintain a reverse (in-edge) index next to the matrix: in_edges[v][u]
+// mirrors edges[u][v], plus per-node degree counters. In-degree becomes O(1),
+// undirected traversal reads two rows instead of a row and a column, and
+// transpose_graph just swaps the two row sets.
+bool enable_in_index(graph *g) {
+    assert(g != NULL);
+    if (g->in_edges != NULL) {
+        return true;
+    }
+    int n = g->numnodes;
+    g->in_edges = allocator_alloc(g->allocator, n * sizeof(bool *));
+    g->in_degree = allocator_alloc(g->allocator, n * sizeof(int));
+    g->out_degree = allocator_alloc(g->allocator, n * sizeof(int));
+    if (g->in_edges == NULL || g->in_degree == NULL || g->out_degree == NULL) {
+        disable_in_index(g);
+        return false;
+    }
+    for (int v = 0; v < n; v++) {
+        g->in_edges[v] = alloc_row(g->allocator, n);
+        if (g->in_edges[v] == NULL) {
+            disable_in_index(g);
+            return false;
+        }
+    }
+
+    for (int u = 0; u < n; u++) {
+        for (int v = 0; v < n; v++) {
+            if (g->edges[u][v]) {
+                g->in_edges[v][u] = true;
+                g->out_degree[u]++;
+                g->in_degree[v]++;
             }
-            free(g->edges);
         }
-        free(g);
     }
+    return true;
+}
+
+void disable_in_index(graph *g) {
+    assert(g != NULL);
+    release_rows(g->allocator, g->in_edges, g->numnodes);
+    allocator_free(g->allocator, g->out_degree, g->numnodes * sizeof(int));
+    allocator_free(g->allocator, g->in_degree, g->numnodes * sizeof(int));
+    g->in_edges = NULL;
+    g->in_degree = NULL;
+    g->out_degree = NULL;
+}
+
+// Undirected adjacency used by bfs/dfs. With the in-edge index both reads
+// come from row 'u'; otherwise the reverse direction is a column access.
+static bool linked(graph *g, int u, int v) {
+    return g->edges[u][v] || (g->in_edges ? g->in_edges[u][v] : g->edges[v][u]);
 }
 
 // Print the graph in DOT format
@@ -63,9 +248,17 @@ bool add_edge(graph *g, unsigned int from_node, unsigned int to_node) {
     assert(from_node < g->numnodes);
     assert(to_node < g->numnodes);
 
-    if (has_edge(g, from_node, to_node)) {
+    if (has_edge(g, from_node, to_node) || !make_row_private(g, g->edges, from_node)) {
         return false;
     }
+    if (g->in_edges != NULL) {
+        if (!make_row_private(g, g->in_edges, to_node)) {
+            return false;
+        }
+        g->in_edges[to_node][from_node] = true;
+        g->out_degree[from_node]++;
+        g->in_degree[to_node]++;
+    }
     g->edges[from_node][to_node] = true;
     return true;
 }
@@ -88,7 +281,7 @@ static void dfs_helper(graph *g, int node, bool *visited) {
         // if (g->edges[node][i] && !visited[i]) {
         //     dfs_helper(g, i, visited);
         // }
-        if ((g->edges[node][i] || g->edges[i][node]) && !visited[i]) {
+        if (linked(g, node, i) && !visited[i]) {
             dfs_helper(g, i, visited);  // Recur for the unvisited node
         }
     }
@@ -96,47 +289,37 @@ static void dfs_helper(graph *g, int node, bool *visited) {
 
 // Perform Depth-First Search (DFS)
 void dfs(graph *g, int start_node) {
-    bool *visited = calloc(g->numnodes, sizeof(bool));
+    bool *visited = scratch_alloc(g, g->numnodes * sizeof(bool));
     if (visited == NULL) {
         printf("Memory allocation failed\n");
         return;
     }
     dfs_helper(g, start_node, visited);
     printf("\n");
-    free(visited);
+    scratch_free(g, visited, g->numnodes * sizeof(bool));
 }
 
-// Perform Breadth-First Search (BFS)
+// Perform Breadth-First Search (BFS), following edges both ways
 void bfs(graph *g, int start_node) {
-    bool *visited = calloc(g->numnodes, sizeof(bool));
-    int *queue = malloc(g->numnodes * sizeof(int));
-    if (visited == NULL || queue == NULL) {
+    graph_view *view = create_graph_view(g, false);
+    int *distances = scratch_alloc(g, g->numnodes * sizeof(int));
+    int *order = scratch_alloc(g, g->numnodes * sizeof(int));
+    if (view == NULL || distances == NULL || order == NULL) {
         printf("Memory allocation failed\n");
+        scratch_free(g, order, g->numnodes * sizeof(int));
+        scratch_free(g, distances, g->numnodes * sizeof(int));
+        destroy_graph_view(view);
         return;
     }
 
-    int front = 0, rear = 0;
-    visited[start_node] = true;
-    queue[rear++] = start_node;
-
-    while (front < rear) {
-        int node = queue[front++];
-        printf("%d ", node);
-
-        for (int i = 0; i < g->numnodes; i++) {
-            // if (g->edges[node][i] && !visited[i]) {
-            //     visited[i] = true;
-            //     queue[rear++] = i;
-            // }
-            if ((g->edges[node][i] || g->edges[i][node]) && !visited[i]) {
-                visited[i] = true;  // Mark the node as visited
-                queue[rear++] = i;   // Enqueue the unvisited node
-            }
-        }
+    int reached = view_bfs(view, start_node, distances, order);
+    for (int i = 0; i < reached; i++) {
+        printf("%d ", order[i]);
     }
     printf("\n");
-    free(visited);
-    free(queue);
+    scratch_free(g, order, g->numnodes * sizeof(int));
+    scratch_free(g, distances, g->numnodes * sizeof(int));
+    destroy_graph_view(view);
 }
 
 // Helper function to detect a cycle in the graph
@@ -171,81 +354,45 @@ bool is_cyclic_helper(graph *g, int node, bool *visited, bool *rec_stack) {
 // Check if the graph has a cycle
 bool is_cyclic(graph *g) {
     // Allocate visited and rec_stack arrays
-    bool *visited = calloc(g->numnodes, sizeof(bool));
-    bool *rec_stack = calloc(g->numnodes, sizeof(bool));
+    bool *visited = scratch_alloc(g, g->numnodes * sizeof(bool));
+    bool *rec_stack = scratch_alloc(g, g->numnodes * sizeof(bool));
 
     if (visited == NULL || rec_stack == NULL) {
         printf("Memory allocation failed\n");
+        scratch_free(g, rec_stack, g->numnodes * sizeof(bool));
+        scratch_free(g, visited, g->numnodes * sizeof(bool));
         return false;
     }
 
     // Check for cycles in all unvisited nodes
-    for (int i = 0; i < g->numnodes; i++) {
+    bool cyclic = false;
+    for (int i = 0; i < g->numnodes && !cyclic; i++) {
         if (!visited[i]) {
-            if (is_cyclic_helper(g, i, visited, rec_stack)) {
-                free(visited);
-                free(rec_stack);
-                return true;
-            }
+            cyclic = is_cyclic_helper(g, i, visited, rec_stack);
         }
     }
 
-    // No cycle found
-    free(visited);
-    free(rec_stack);
-    return false;
+    scratch_free(g, rec_stack, g->numnodes * sizeof(bool));
+    scratch_free(g, visited, g->numnodes * sizeof(bool));
+    return cyclic;
 }
 
 // Dijkstra's algorithm to find the shortest paths and store paths
 #define INF INT_MAX
 
 int *shortest_path_dijkstra(graph *g, int start_node, int end_node, int **predecessors) {
+    graph_view *view = create_graph_view(g, true);
     int *distances = malloc(g->numnodes * sizeof(int));
     *predecessors = malloc(g->numnodes * sizeof(int));
-    bool *visited = calloc(g->numnodes, sizeof(bool));
-    if (distances == NULL || visited == NULL || *predecessors == NULL) {
+    if (view == NULL || distances == NULL || *predecessors == NULL ||
+        !view_dijkstra(view, start_node, end_node, distances, *predecessors)) {
         printf("Memory allocation failed\n");
+        destroy_graph_view(view);
         free(distances);
         free(*predecessors);
-        free(visited);
         return NULL;
     }
-
-    // Initialize distances and predecessors
-    for (int i = 0; i < g->numnodes; i++) {
-        distances[i] = INF;
-        (*predecessors)[i] = -1;  // Initialize predecessors to -1 (no path)
-    }
-    distances[start_node] = 0;
-
-    for (int i = 0; i < g->numnodes; i++) {
-        // Find the unvisited node with the smallest distance
-        int min_dist = INF;
-        int u = -1;
-        for (int j = 0; j < g->numnodes; j++) {
-            if (!visited[j] && distances[j] < min_dist) {
-                min_dist = distances[j];
-                u = j;
-            }
-        }
-        if (u == -1) break; // No more reachable nodes
-
-        visited[u] = true;
-
-        // Early exit if we reached the end node
-        if (u == end_node) break;
-
-        // Relax edges
-        for (int v = 0; v < g->numnodes; v++) {
-            if (g->edges[u][v] && !visited[v] && distances[u] != INF &&
-                distances[u] + g->edges[u][v] < distances[v]) {
-                distances[v] = distances[u] + g->edges[u][v];
-                (*predecessors)[v] = u;  // Update predecessor
-            }
-        }
-    }
-
-    free(visited);
+    destroy_graph_view(view);
     return distances;
 }
 
@@ -266,7 +413,12 @@ void print_path(int *predecessors, int start_node, int end_node) {
 
 // Transpose a graph
 graph *transpose_graph(graph *g) {
-    graph *transposed = create_graph(g->numnodes);
+    // With the in-edge index the transpose is already built
+    if (g->in_edges != NULL) {
+        return share_graph(g, true);
+    }
+
+    graph *transposed = create_graph_with_allocator(g->numnodes, g->allocator);
     if (transposed == NULL) {
         return NULL;
     }
@@ -288,9 +440,17 @@ bool remove_edge(graph *g, unsigned int from_node, unsigned int to_node) {
     assert(from_node < g->numnodes);
     assert(to_node < g->numnodes);
 
-    if (!has_edge(g, from_node, to_node)) {
+    if (!has_edge(g, from_node, to_node) || !make_row_private(g, g->edges, from_node)) {
         return false;
     }
+    if (g->in_edges != NULL) {
+        if (!make_row_private(g, g->in_edges, to_node)) {
+            return false;
+        }
+        g->in_edges[to_node][from_node] = false;
+        g->out_degree[from_node]--;
+        g->in_degree[to_node]--;
+    }
     g->edges[from_node][to_node] = false;
     return true;
 }
@@ -299,6 +459,9 @@ int get_in_degree(graph *g, unsigned int node) {
     assert(g != NULL);
     assert(node < g->numnodes);
     
+    if (g->in_degree != NULL) {
+        return g->in_degree[node];
+    }
     int count = 0;
     for(int i = 0; i < g->numnodes; i++) {
         if(g->edges[i][node]) {
@@ -312,6 +475,9 @@ int get_out_degree(graph *g, unsigned int node) {
     assert(g != NULL);
     assert(node < g->numnodes);
     
+    if (g->out_degree != NULL) {
+        return g->out_degree[node];
+    }
     int count = 0;
     for(int i = 0; i < g->numnodes; i++) {
         if(g->edges[node][i]) {
@@ -324,97 +490,94 @@ int get_out_degree(graph *g, unsigned int node) {
 // Minimum Spanning Tree (Prim's Algorithm) - For weighted graphs
 
 edge* get_minimum_spanning_tree(graph *g) {
-    bool *visited = calloc(g->numnodes, sizeof(bool));
+    graph_view *view = create_graph_view(g, true);
     edge *mst = malloc((g->numnodes - 1) * sizeof(edge));
-    int *key = malloc(g->numnodes * sizeof(int));
-    int *parent = malloc(g->numnodes * sizeof(int));
-    
-    if(!visited || !mst || !key || !parent) {
-        free(visited);
+    int *parent = scratch_alloc(g, g->numnodes * sizeof(int));
+    int *key = scratch_alloc(g, g->numnodes * sizeof(int));
+
+    if(!view || !mst || !parent || !key || view_spanning_forest(view, parent, key) < 0) {
+        scratch_free(g, key, g->numnodes * sizeof(int));
+        scratch_free(g, parent, g->numnodes * sizeof(int));
+        destroy_graph_view(view);
         free(mst);
-        free(key);
-        free(parent);
         return NULL;
     }
-    
-    // Initialize keys and parent
-    for(int i = 0; i < g->numnodes; i++) {
-        key[i] = INT_MAX;
-        parent[i] = -1;
-    }
-    
-    key[0] = 0;  // Start with vertex 0
-    
-    for(int count = 0; count < g->numnodes - 1; count++) {
-        // Find vertex with minimum key
-        int min_key = INT_MAX;
-        int min_index = -1;
-        
-        for(int v = 0; v < g->numnodes; v++) {
-            if(!visited[v] && key[v] < min_key) {
-                min_key = key[v];
-                min_index = v;
-            }
-        }
-        
-        visited[min_index] = true;
-        
-        // Update key values of adjacent vertices
-        for(int v = 0; v < g->numnodes; v++) {
-            if(g->edges[min_index][v] && !visited[v] && 1 < key[v]) {
-                parent[v] = min_index;
-                key[v] = 1;  // Using weight 1 for unweighted graph
-            }
-        }
-    }
-    
-    // Construct MST edges
+
+    // Construct MST edges; the root of each tree keeps parent -1
     for(int i = 1; i < g->numnodes; i++) {
         mst[i-1].from = parent[i];
         mst[i-1].to = i;
         mst[i-1].weight = 1;  // Using weight 1 for unweighted graph
     }
-    
-    free(visited);
-    free(key);
-    free(parent);
+
+    scratch_free(g, key, g->numnodes * sizeof(int));
+    scratch_free(g, parent, g->numnodes * sizeof(int));
+    destroy_graph_view(view);
     return mst;
 }
 
+// Every edge as a (from, to, 1) triple in row-major order, for algorithms
+// that take an edge list with weights or capacities
+edge *get_edge_list(graph *g, int *numedges) {
+    int m = 0;
+    for(int i = 0; i < g->numnodes; i++) {
+        m += get_out_degree(g, i);
+    }
+    edge *edges = malloc((m > 0 ? m : 1) * sizeof(edge));
+    if(!edges) return NULL;
+
+    int k = 0;
+    for(int i = 0; i < g->numnodes; i++) {
+        for(int j = 0; j < g->numnodes; j++) {
+            if(g->edges[i][j]) {
+                edges[k].from = i;
+                edges[k].to = j;
+                edges[k].weight = 1;
+                k++;
+            }
+        }
+    }
+    *numedges = k;
+    return edges;
+}
+
 // Graph properties checkers
 bool is_connected(graph *g) {
-    bool *visited = calloc(g->numnodes, sizeof(bool));
+    bool *visited = scratch_alloc(g, g->numnodes * sizeof(bool));
     if(!visited) return false;
     
     // Start DFS from vertex 0
     dfs_helper(g, 0, visited);
     
     // Check if all vertices were visited
+    bool connected = true;
     for(int i = 0; i < g->numnodes; i++) {
         if(!visited[i]) {
-            free(visited);
-            return false;
+            connected = false;
+            break;
         }
     }
     
-    free(visited);
-    return true;
+    scratch_free(g, visited, g->numnodes * sizeof(bool));
+    return connected;
 }
 
+// Copy-on-write clone: the clone shares every row with 'g' and rows are only
+// duplicated when add_edge/remove_edge modifies them on either graph. Edges
+// must not be written through g->edges directly once a graph is shared.
 graph* clone_graph(graph *g) {
     if(!g) return NULL;
-    
-    graph *clone = create_graph(g->numnodes);
-    if(!clone) return NULL;
-    
-    // Copy all edges
-    for(int i = 0; i < g->numnodes; i++) {
-        for(int j = 0; j < g->numnodes; j++) {
-            clone->edges[i][j] = g->edges[i][j];
-        }
-    }
-    
-    return clone;
+    return share_graph(g, false);
+}
+
+// xorshift64* generator shared by the sampling algorithms
+unsigned int next_random(unsigned long long *state) {
+    unsigned long long x = *state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+    return (unsigned int)((x * 0x2545F4914F6CDD1DULL) >> 32);
 }
 
 // -------------------- Visualization --------------------------
@@ -29,13 +29,20 @@ void show_graph_menu()
     printf("7. Transpose Graph\n");
     printf("8. Check In-degree and Out-degree of Node\n");
     printf("9. Check if Graph is Connected\n");
+    printf("10. Rank Nodes (PageRank and Betweenness)\n");
+    printf("11. Count Triangles and Clustering Coefficients\n");
+    printf("12. Detect Communities (Louvain)\n");
+    printf("13. Maximum Flow and Minimum Cut\n");
     printf("0. Back to Main Menu\n");
     printf("===============================\n");
     printf("Enter your choice: ");
 }
 
+#define MAX_RECOMMENDATIONS 10
+
 // Function to recommend friends for a user
-void recommend_friends(graph *g, int user)
+void recommend_friends(graph *g, csr_graph **ppr_view, ppr_workspace **ppr_ws, int user,
+                       recommend_mode mode)
 {
     printf("\n===== Friend Recommendations for User %d =====\n", user);
 
@@ -45,6 +52,12 @@ void recommend_friends(graph *g, int user)
         return;
     }
 
+    if (mode != RECOMMEND_REACHABLE)
+    {
+        recommend_friends_ppr(g, ppr_view, ppr_ws, user, MAX_RECOMMENDATIONS, mode);
+        return;
+    }
+
     int *distances = NULL;
     int *predecessors = NULL;
 
@@ -90,9 +103,10 @@ int main()
     printf("Enter the number of nodes in the graph: ");
     scanf("%d", &graphNodes);
     g = create_graph(graphNodes);
-    if (!g)
+    if (!g || !enable_in_index(g))
     {
         printf("Failed to create graph. Exiting...\n");
+        destroy_graph(g);
         return 1;
     }
 
@@ -232,6 +246,109 @@ int main()
                     printf("Is the graph connected? %s\n", is_connected(g) ? "Yes" : "No");
                     break;
 
+                case 10: // Rank Nodes
+                {
+                    double *ranks = pagerank(g, 0.85, 1e-9, 100);
+                    double *betweenness = approximate_betweenness(g, graphNodes, 1);
+                    if (ranks && betweenness)
+                    {
+                        printf("Node  PageRank  Betweenness\n");
+                        for (int i = 0; i < graphNodes; i++)
+                        {
+                            printf("%4d  %8.5f  %11.2f\n", i, ranks[i], betweenness[i]);
+                        }
+                    }
+                    else
+                    {
+                        printf("Failed to rank nodes.\n");
+                    }
+                    free(ranks);
+                    free(betweenness);
+                    break;
+                }
+
+                case 11: // Triangles and Clustering
+                {
+                    triangle_stats *stats = count_triangles(g);
+                    if (stats)
+                    {
+                        printf("Triangles: %lld, Transitivity: %.4f\n", stats->triangles, stats->transitivity);
+                        printf("Node  Triangles  Clustering\n");
+                        for (int i = 0; i < graphNodes; i++)
+                        {
+                            printf("%4d  %9lld  %10.4f\n", i, stats->per_node[i], stats->clustering[i]);
+                        }
+                        destroy_triangle_stats(stats);
+                    }
+                    else
+                    {
+                        printf("Failed to count triangles.\n");
+                    }
+                    break;
+                }
+
+                case 12: // Community Detection
+                {
+                    community_result *communities = louvain(g, 20);
+                    if (communities)
+                    {
+                        printf("%d communities, modularity %.4f\n", communities->numcommunities, communities->modularity);
+                        for (int i = 0; i < graphNodes; i++)
+                        {
+                            printf("Node %d -> Community %d\n", i, communities->community[i]);
+                        }
+                        destroy_community_result(communities);
+                    }
+                    else
+                    {
+                        printf("Failed to detect communities.\n");
+                    }
+                    break;
+                }
+
+                case 13: // Maximum Flow (every edge has capacity 1)
+                {
+                    printf("Enter the source node: ");
+                    scanf("%d", &startNode);
+                    printf("Enter the sink node: ");
+                    scanf("%d", &endNode);
+                    if (startNode < 0 || startNode >= graphNodes || endNode < 0 || endNode >= graphNodes || startNode == endNode)
+                    {
+                        printf("Invalid node(s). Please enter two different valid indices.\n");
+                        break;
+                    }
+                    int numEdges = 0;
+                    edge *edges = get_edge_list(g, &numEdges);
+                    flow_result *flow = edges ? max_flow(graphNodes, edges, numEdges, startNode, endNode, FLOW_PUSH_RELABEL) : NULL;
+                    if (flow)
+                    {
+                        printf("Maximum flow from %d to %d: %lld\n", startNode, endNode, flow->value);
+                        for (int i = 0; i < numEdges; i++)
+                        {
+                            if (flow->flow[i] > 0)
+                            {
+                                printf("Edge %d -> %d carries %d\n", edges[i].from, edges[i].to, flow->flow[i]);
+                            }
+                        }
+                        printf("Minimum cut (source side):");
+                        for (int i = 0; i < graphNodes; i++)
+                        {
+                            if (flow->source_side[i])
+                            {
+                                printf(" %d", i);
+                            }
+                        }
+                        printf("\n");
+                        destroy_flow_result(flow);
+                    }
+                    else
+                    {
+                        printf("Failed to compute maximum flow.\n");
+                    }
+                    free(edges);
+                    break;
+                }
+
                 case 0:
                     printf("Returning to Main Menu...\n");
                     break;
@@ -295,11 +412,18 @@ int main()
             }
 
             int choice, from, to, user;
+            csr_graph *separation_view = NULL;
+            alt_index *separation_index = NULL;
+            alt_workspace *separation_ws = NULL;
+            csr_graph *ppr_view = NULL;
+            ppr_workspace *ppr_ws = NULL;
             do
             {
                 printf("\n===== Friend Recommendation System =====\n");
                 printf("1. Add Friendship\n");
                 printf("2. Recommend Friends for a User\n");
+                printf("3. Recommend Friends by Personalized PageRank\n");
+                printf("4. Degrees of Separation\n");
                 printf("0. Exit\n");
                 printf("Enter your choice: ");
                 scanf("%d", &choice);
@@ -316,6 +440,14 @@ int main()
                     else if (add_edge(social_network, from, to))
                     {
                         printf("Friendship added between User %d and User %d.\n", from, to);
+                        destroy_alt(separation_index);
+                        destroy_csr(separation_view);
+                        destroy_alt_workspace(separation_ws);
+                        destroy_csr(ppr_view);
+                        separation_index = NULL;
+                        separation_ws = NULL;
+                        separation_view = NULL;
+                        ppr_view = NULL;
                     }
                     else
                     {
@@ -326,7 +458,20 @@ int main()
                 case 2: // Recommend friends
                     printf("Enter the user ID to recommend friends for: ");
                     scanf("%d", &user);
-                    recommend_friends(social_network, user);
+                    recommend_friends(social_network, &ppr_view, &ppr_ws, user, RECOMMEND_REACHABLE);
+                    break;
+
+                case 3: // Recommend friends by personalized PageRank
+                    printf("Enter the user ID to recommend friends for: ");
+                    scanf("%d", &user);
+                    recommend_friends(social_network, &ppr_view, &ppr_ws, user, RECOMMEND_PPR_PUSH);
+                    break;
+
+                case 4: // Degrees of separation
+                    printf("Enter the two user IDs (from to): ");
+                    scanf("%d %d", &from, &to);
+                    degrees_of_separation(social_network, &separation_view, &separation_index,
+                                          &separation_ws, from, to);
                     break;
 
                 case 0: // Exit
@@ -338,6 +483,11 @@ int main()
                 }
             } while (choice != 0);
             // Clean up
+            destroy_alt(separation_index);
+            destroy_csr(separation_view);
+            destroy_alt_workspace(separation_ws);
+            destroy_csr(ppr_view);
+            destroy_ppr_workspace(ppr_ws);
             destroy_graph(social_network);
             break;
         }
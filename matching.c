@@ -0,0 +1,212 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include "header.h"
+
+// Two-color the graph by BFS; false when an odd cycle makes it non-bipartite
+static bool bipartition(csr_graph *c, bool *left, int *side, int *queue) {
+    int n = c->numnodes;
+    for (int v = 0; v < n; v++) {
+        side[v] = -1;
+    }
+    bool ok = true;
+    for (int root = 0; ok && root < n; root++) {
+        if (side[root] >= 0) {
+            continue;
+        }
+        int head = 0, tail = 0;
+        side[root] = 0;
+        queue[tail++] = root;
+        while (ok && head < tail) {
+            int u = queue[head++];
+            for (int k = c->offsets[u]; k < c->offsets[u + 1]; k++) {
+                int v = c->targets[k];
+                if (side[v] < 0) {
+                    side[v] = 1 - side[u];
+                    queue[tail++] = v;
+                } else if (side[v] == side[u]) {
+                    ok = false;
+                    break;
+                }
+            }
+        }
+    }
+    for (int v = 0; ok && v < n; v++) {
+        left[v] = side[v] == 0;
+    }
+    return ok;
+}
+
+// Layer the free left nodes and the alternating paths leaving them. Returns
+// the length of the shortest augmenting path, INF when there is none.
+static int hk_layers(csr_graph *c, const bool *left, const int *mate, int *dist, int *queue) {
+    int n = c->numnodes;
+    int head = 0, tail = 0;
+    for (int u = 0; u < n; u++) {
+        if (left[u] && mate[u] < 0) {
+            dist[u] = 0;
+            queue[tail++] = u;
+        } else {
+            dist[u] = INF;
+        }
+    }
+    int shortest = INF;
+    while (head < tail) {
+        int u = queue[head++];
+        if (dist[u] >= shortest) {
+            continue;
+        }
+        for (int k = c->offsets[u]; k < c->offsets[u + 1]; k++) {
+            if (left[c->targets[k]]) {
+                continue;
+            }
+            int w = mate[c->targets[k]];
+            if (w < 0) {
+                if (shortest == INF) {
+                    shortest = dist[u] + 1;
+                }
+            } else if (dist[w] == INF) {
+                dist[w] = dist[u] + 1;
+                queue[tail++] = w;
+            }
+        }
+    }
+    return shortest;
+}
+
+// Vertex-disjoint shortest augmenting paths from 'root' by iterative DFS
+// over the layers; 'stack' holds left nodes and 'current' their next arc.
+static bool hk_augment(csr_graph *c, const bool *left, int root, int *mate, int *dist,
+                       int shortest, int *current, int *stack) {
+    int depth = 0;
+    stack[depth++] = root;
+    while (depth > 0) {
+        int u = stack[depth - 1];
+        if (current[u] == c->offsets[u + 1]) {
+            dist[u] = INF;      // dead end for the rest of the phase
+            depth--;
+            if (depth > 0) {
+                current[stack[depth - 1]]++;
+            }
+            continue;
+        }
+        int v = c->targets[current[u]];
+        int w = left[v] ? u : mate[v];      // same-side edges never match
+        if (w < 0 && dist[u] + 1 == shortest) {
+            // Flip the path: every left node on the stack takes its arc
+            for (int i = depth - 1; i >= 0; i--) {
+                int x = stack[i];
+                int y = c->targets[current[x]];
+                mate[y] = x;
+                mate[x] = y;
+                current[x]++;
+            }
+            return true;
+        }
+        if (w >= 0 && dist[w] == dist[u] + 1) {
+            stack[depth++] = w;
+        } else {
+            current[u]++;
+        }
+    }
+    return false;
+}
+
+// Maximum matching between the 'left' nodes and the rest (Hopcroft-Karp):
+// each phase finds a maximal set of shortest augmenting paths, for
+// O(sqrt(V) * E) overall. With 'left' NULL the sides come from
+// two-coloring, and a non-bipartite graph yields NULL. 'c' must list
+// neighbors in both directions (build_csr_undirected).
+matching_result *hopcroft_karp_csr(csr_graph *c, const bool *left) {
+    assert(c != NULL);
+    int n = c->numnodes;
+    matching_result *m = calloc(1, sizeof(*m));
+    int *dist = malloc((n > 0 ? n : 1) * sizeof(int));
+    int *queue = malloc((n > 0 ? n : 1) * sizeof(int));
+    int *current = malloc((n > 0 ? n : 1) * sizeof(int));
+    bool *sides = left ? NULL : malloc((n > 0 ? n : 1) * sizeof(bool));
+    if (m != NULL) {
+        m->numnodes = n;
+        m->mate = malloc((n > 0 ? n : 1) * sizeof(int));
+    }
+    bool ok = m && m->mate && dist && queue && current && (left || sides);
+    if (ok && left == NULL) {
+        if (!bipartition(c, sides, dist, queue)) {
+            printf("Graph is not bipartite\n");
+            free(dist);
+            free(queue);
+            free(current);
+            free(sides);
+            destroy_matching_result(m);
+            return NULL;
+        }
+        left = sides;
+    }
+
+    if (ok) {
+        // Greedy start: most of the matching is found without any search
+        for (int v = 0; v < n; v++) {
+            m->mate[v] = -1;
+        }
+        for (int u = 0; u < n; u++) {
+            if (!left[u]) {
+                continue;
+            }
+            for (int k = c->offsets[u]; k < c->offsets[u + 1]; k++) {
+                int v = c->targets[k];
+                if (!left[v] && m->mate[v] < 0) {
+                    m->mate[u] = v;
+                    m->mate[v] = u;
+                    break;
+                }
+            }
+        }
+
+        int shortest;
+        while ((shortest = hk_layers(c, left, m->mate, dist, queue)) != INF) {
+            for (int u = 0; u < n; u++) {
+                current[u] = c->offsets[u];
+            }
+            for (int u = 0; u < n; u++) {
+                if (left[u] && m->mate[u] < 0) {
+                    hk_augment(c, left, u, m->mate, dist, shortest, current, queue);
+                }
+            }
+        }
+        for (int u = 0; u < n; u++) {
+            m->size += left[u] && m->mate[u] >= 0;
+        }
+    }
+
+    free(dist);
+    free(queue);
+    free(current);
+    free(sides);
+    if (!ok) {
+        printf("Memory allocation failed\n");
+        destroy_matching_result(m);
+        return NULL;
+    }
+    return m;
+}
+
+// Matching over the graph's edges taken in either direction, e.g. job ->
+// worker edges with 'left' marking the jobs
+matching_result *hopcroft_karp(graph *g, const bool *left) {
+    assert(g != NULL);
+    csr_graph *c = build_csr_undirected(g);
+    if (c == NULL) {
+        printf("Memory allocation failed\n");
+        return NULL;
+    }
+    matching_result *m = hopcroft_karp_csr(c, left);
+    destroy_csr(c);
+    return m;
+}
+
+void destroy_matching_result(matching_result *m) {
+    if (m != NULL) {
+        free(m->mate);
+        free(m);
+    }
+}
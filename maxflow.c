@@ -0,0 +1,433 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "header.h"
+
+// Residual network: the arcs of u are offsets[u] .. offsets[u + 1]; every
+// input edge owns a forward arc (capacity = edge weight) and a reverse arc
+// (capacity 0) that point at each other through 'rev'.
+typedef struct {
+    int numnodes;
+    int *offsets;
+    int *head;
+    int *cap;       // residual capacity
+    int *rev;
+    int *edge_arc;  // forward arc of each input edge
+} residual_graph;
+
+static void destroy_residual(residual_graph *r) {
+    free(r->offsets);
+    free(r->head);
+    free(r->cap);
+    free(r->rev);
+    free(r->edge_arc);
+}
+
+static bool build_residual(residual_graph *r, int n, const edge *edges, int numedges) {
+    int arcs = 2 * numedges;
+    r->numnodes = n;
+    r->offsets = calloc(n + 1, sizeof(int));
+    r->head = malloc((arcs > 0 ? arcs : 1) * sizeof(int));
+    r->cap = malloc((arcs > 0 ? arcs : 1) * sizeof(int));
+    r->rev = malloc((arcs > 0 ? arcs : 1) * sizeof(int));
+    r->edge_arc = malloc((numedges > 0 ? numedges : 1) * sizeof(int));
+    if (r->offsets == NULL || r->head == NULL || r->cap == NULL || r->rev == NULL || r->edge_arc == NULL) {
+        destroy_residual(r);
+        return false;
+    }
+
+    for (int i = 0; i < numedges; i++) {
+        assert(edges[i].from >= 0 && edges[i].from < n && edges[i].to >= 0 && edges[i].to < n);
+        assert(edges[i].weight >= 0);
+        r->offsets[edges[i].from + 1]++;
+        r->offsets[edges[i].to + 1]++;
+    }
+    for (int v = 0; v < n; v++) {
+        r->offsets[v + 1] += r->offsets[v];
+    }
+    for (int i = 0; i < numedges; i++) {
+        int a = r->offsets[edges[i].from]++;
+        int b = r->offsets[edges[i].to]++;
+        r->head[a] = edges[i].to;
+        r->cap[a] = edges[i].weight;
+        r->head[b] = edges[i].from;
+        r->cap[b] = 0;
+        r->rev[a] = b;
+        r->rev[b] = a;
+        r->edge_arc[i] = a;
+    }
+    for (int v = n; v > 0; v--) {
+        r->offsets[v] = r->offsets[v - 1];
+    }
+    r->offsets[0] = 0;
+    return true;
+}
+
+// Hop distance of every node *to* 'root' over arcs with residual capacity
+// (INF when it cannot reach it), by BFS along reverse arcs. Paths through
+// 'skip' do not count and 'skip' itself stays at INF.
+static void distances_to(residual_graph *r, int root, int skip, int *dist, int *queue) {
+    for (int v = 0; v < r->numnodes; v++) {
+        dist[v] = INF;
+    }
+    int head = 0, tail = 0;
+    dist[root] = 0;
+    queue[tail++] = root;
+    while (head < tail) {
+        int v = queue[head++];
+        for (int a = r->offsets[v]; a < r->offsets[v + 1]; a++) {
+            int u = r->head[a];
+            if (dist[u] == INF && u != skip && r->cap[r->rev[a]] > 0) {
+                dist[u] = dist[v] + 1;
+                queue[tail++] = u;
+            }
+        }
+    }
+}
+
+// ----------------- Dinic -----------------
+
+// Level graph by BFS from the source; false once the sink is unreachable
+static bool dinic_levels(residual_graph *r, int source, int sink, int *level, int *queue) {
+    for (int v = 0; v < r->numnodes; v++) {
+        level[v] = -1;
+    }
+    int head = 0, tail = 0;
+    level[source] = 0;
+    queue[tail++] = source;
+    while (head < tail) {
+        int u = queue[head++];
+        for (int a = r->offsets[u]; a < r->offsets[u + 1]; a++) {
+            int v = r->head[a];
+            if (level[v] < 0 && r->cap[a] > 0) {
+                level[v] = level[u] + 1;
+                queue[tail++] = v;
+            }
+        }
+    }
+    return level[sink] >= 0;
+}
+
+// Blocking flow by repeated augmenting DFS along level-increasing arcs.
+// The search is iterative ('path' holds the arcs taken) and 'current'
+// skips arcs already found useless in this phase.
+static long long dinic_blocking(residual_graph *r, int source, int sink, int *level,
+                                int *current, int *path) {
+    long long total = 0;
+    int depth = 0, u = source;
+    for (int v = 0; v < r->numnodes; v++) {
+        current[v] = r->offsets[v];
+    }
+    for (;;) {
+        if (u == sink) {
+            int bottleneck = INF;
+            for (int i = 0; i < depth; i++) {
+                if (r->cap[path[i]] < bottleneck) {
+                    bottleneck = r->cap[path[i]];
+                }
+            }
+            int retreat = depth;
+            for (int i = depth - 1; i >= 0; i--) {
+                r->cap[path[i]] -= bottleneck;
+                r->cap[r->rev[path[i]]] += bottleneck;
+                if (r->cap[path[i]] == 0) {
+                    retreat = i;
+                }
+            }
+            total += bottleneck;
+            // Resume from the tail of the first saturated arc
+            depth = retreat;
+            u = depth > 0 ? r->head[path[depth - 1]] : source;
+            continue;
+        }
+
+        int a = current[u];
+        while (a < r->offsets[u + 1] && (r->cap[a] == 0 || level[r->head[a]] != level[u] + 1)) {
+            a++;
+        }
+        current[u] = a;
+        if (a < r->offsets[u + 1]) {
+            path[depth++] = a;
+            u = r->head[a];
+            continue;
+        }
+
+        // Dead end: drop u from this phase and back up
+        level[u] = -1;
+        if (depth == 0) {
+            return total;
+        }
+        depth--;
+        u = depth > 0 ? r->head[path[depth - 1]] : source;
+        current[u]++;
+    }
+}
+
+static bool run_dinic(residual_graph *r, int source, int sink, long long *value) {
+    int n = r->numnodes;
+    int *level = malloc(n * sizeof(int));
+    int *queue = malloc(n * sizeof(int));
+    int *current = malloc(n * sizeof(int));
+    int *path = malloc(n * sizeof(int));
+    bool ok = level && queue && current && path;
+    *value = 0;
+    while (ok && dinic_levels(r, source, sink, level, queue)) {
+        *value += dinic_blocking(r, source, sink, level, current, path);
+    }
+    free(level);
+    free(queue);
+    free(current);
+    free(path);
+    return ok;
+}
+
+// ----------------- Highest-label push-relabel -----------------
+
+typedef struct {
+    residual_graph *r;
+    int source;
+    int sink;
+    int limit;          // nodes at or above this height are out of the phase
+    bool gaps;
+    long long *excess;
+    int *height;
+    int *current;
+    int *bucket;        // first active node at each height
+    int *next;          // next active node in the same bucket
+    int *count;         // nodes at each height below 'limit' (gap detection)
+    int highest;        // no active node is higher than this
+    int relabels;
+    int *queue;
+} preflow;
+
+static void activate(preflow *p, int v) {
+    int h = p->height[v];
+    p->next[v] = p->bucket[h];
+    p->bucket[h] = v;
+    if (h > p->highest) {
+        p->highest = h;
+    }
+}
+
+// Exact heights from BFS distances to 'root' (global relabeling), which is
+// one terminal; the other terminal and nodes that cannot reach the root
+// leave the phase. Rebuilds the active buckets.
+static void global_relabel(preflow *p, int root) {
+    int n = p->r->numnodes;
+    distances_to(p->r, root, root == p->sink ? p->source : p->sink, p->height, p->queue);
+    for (int h = 0; h <= 2 * n; h++) {
+        p->bucket[h] = -1;
+        p->count[h] = 0;
+    }
+    p->highest = 0;
+    for (int v = 0; v < n; v++) {
+        if (p->height[v] == INF) {
+            p->height[v] = p->limit;
+        }
+        if (p->height[v] < p->limit) {
+            p->count[p->height[v]]++;
+            if (p->excess[v] > 0 && v != p->source && v != p->sink) {
+                activate(p, v);
+            }
+        }
+        p->current[v] = p->r->offsets[v];
+    }
+    p->relabels = 0;
+}
+
+// Gap: no node is left at 'h', so every node above it can no longer reach
+// the sink and leaves the phase
+static void close_gap(preflow *p, int h) {
+    for (int v = 0; v < p->r->numnodes; v++) {
+        if (p->height[v] > h && p->height[v] < p->limit) {
+            p->count[p->height[v]]--;
+            p->height[v] = p->limit;
+        }
+    }
+}
+
+// Push u's excess to lower neighbors, relabeling when none is admissible
+static void discharge(preflow *p, int u) {
+    residual_graph *r = p->r;
+    while (p->excess[u] > 0) {
+        int a = p->current[u];
+        for (; a < r->offsets[u + 1]; a++) {
+            int v = r->head[a];
+            if (r->cap[a] > 0 && p->height[u] == p->height[v] + 1) {
+                long long amount = p->excess[u] < r->cap[a] ? p->excess[u] : r->cap[a];
+                if (p->excess[v] == 0 && v != p->source && v != p->sink) {
+                    activate(p, v);
+                }
+                r->cap[a] -= (int)amount;
+                r->cap[r->rev[a]] += (int)amount;
+                p->excess[u] -= amount;
+                p->excess[v] += amount;
+                if (p->excess[u] == 0) {
+                    break;
+                }
+            }
+        }
+        p->current[u] = a < r->offsets[u + 1] ? a : r->offsets[u];
+        if (p->excess[u] == 0) {
+            return;
+        }
+
+        // Relabel
+        int old = p->height[u];
+        int lowest = INF;
+        for (int b = r->offsets[u]; b < r->offsets[u + 1]; b++) {
+            if (r->cap[b] > 0 && p->height[r->head[b]] < lowest) {
+                lowest = p->height[r->head[b]];
+            }
+        }
+        p->relabels++;
+        p->count[old]--;
+        p->height[u] = lowest == INF || lowest + 1 >= p->limit ? p->limit : lowest + 1;
+        if (p->height[u] < p->limit) {
+            p->count[p->height[u]]++;     // before a gap lifts u along with the rest
+        }
+        if (p->gaps && p->count[old] == 0) {
+            close_gap(p, old);
+        }
+        if (p->height[u] >= p->limit) {
+            return;
+        }
+    }
+}
+
+// Discharge active nodes highest first until none is left below the limit,
+// refreshing heights from 'root' every n relabels
+static void discharge_all(preflow *p, int root) {
+    int n = p->r->numnodes;
+    for (;;) {
+        while (p->highest >= 0 && p->bucket[p->highest] < 0) {
+            p->highest--;
+        }
+        if (p->highest < 0) {
+            return;
+        }
+        int u = p->bucket[p->highest];
+        p->bucket[p->highest] = p->next[u];
+        if (p->height[u] >= p->limit || p->excess[u] == 0) {
+            continue;
+        }
+        discharge(p, u);
+        if (p->relabels >= n) {
+            global_relabel(p, root);
+        }
+    }
+}
+
+// Phase one moves a maximum preflow into the sink; phase two returns the
+// excess stranded behind the cut to the source, leaving a valid flow.
+static bool run_push_relabel(residual_graph *r, int source, int sink, long long *value) {
+    int n = r->numnodes;
+    preflow p = { r, source, sink, n, true };
+    p.excess = calloc(n, sizeof(long long));
+    p.height = malloc(n * sizeof(int));
+    p.current = malloc(n * sizeof(int));
+    p.next = malloc(n * sizeof(int));
+    p.queue = malloc(n * sizeof(int));
+    p.bucket = malloc((2 * n + 1) * sizeof(int));
+    p.count = malloc((2 * n + 1) * sizeof(int));
+    bool ok = p.excess && p.height && p.current && p.next && p.queue && p.bucket && p.count;
+
+    if (ok) {
+        for (int a = r->offsets[source]; a < r->offsets[source + 1]; a++) {
+            int amount = r->cap[a];
+            r->cap[a] = 0;
+            r->cap[r->rev[a]] += amount;
+            p.excess[r->head[a]] += amount;
+            p.excess[source] -= amount;
+        }
+        global_relabel(&p, sink);
+        discharge_all(&p, sink);
+        *value = p.excess[sink];
+
+        // Heights now lead back to the source, which every stranded unit
+        // can reach along the arcs it came by
+        p.limit = 2 * n;
+        p.gaps = false;
+        global_relabel(&p, source);
+        discharge_all(&p, source);
+    }
+
+    free(p.excess);
+    free(p.height);
+    free(p.current);
+    free(p.next);
+    free(p.queue);
+    free(p.bucket);
+    free(p.count);
+    return ok;
+}
+
+// Maximum flow from 'source' to 'sink' where each edge's weight is its
+// capacity. Reports the flow on every input edge (same order) and the
+// minimum cut as the nodes still reachable from the source in the residual
+// network; the cut edges are the saturated ones leaving that side.
+flow_result *max_flow(int numnodes, const edge *edges, int numedges, int source, int sink,
+                      flow_method method) {
+    assert(edges != NULL || numedges == 0);
+    assert(source >= 0 && source < numnodes && sink >= 0 && sink < numnodes && source != sink);
+    residual_graph r;
+    flow_result *result = calloc(1, sizeof(*result));
+    if (result == NULL || !build_residual(&r, numnodes, edges, numedges)) {
+        printf("Memory allocation failed\n");
+        free(result);
+        return NULL;
+    }
+    result->numnodes = numnodes;
+    result->numedges = numedges;
+    result->flow = malloc((numedges > 0 ? numedges : 1) * sizeof(int));
+    result->source_side = calloc(numnodes, sizeof(bool));
+    int *dist = malloc(numnodes * sizeof(int));
+    int *queue = malloc(numnodes * sizeof(int));
+    bool ok = result->flow && result->source_side && dist && queue;
+
+    if (ok) {
+        ok = method == FLOW_DINIC ? run_dinic(&r, source, sink, &result->value)
+                                  : run_push_relabel(&r, source, sink, &result->value);
+    }
+    if (ok) {
+        for (int i = 0; i < numedges; i++) {
+            result->flow[i] = edges[i].weight - r.cap[r.edge_arc[i]];
+        }
+        // Reachable from the source: BFS along arcs with capacity left
+        for (int v = 0; v < numnodes; v++) {
+            dist[v] = INF;
+        }
+        int head = 0, tail = 0;
+        dist[source] = 0;
+        queue[tail++] = source;
+        while (head < tail) {
+            int u = queue[head++];
+            result->source_side[u] = true;
+            for (int a = r.offsets[u]; a < r.offsets[u + 1]; a++) {
+                if (r.cap[a] > 0 && dist[r.head[a]] == INF) {
+                    dist[r.head[a]] = 0;
+                    queue[tail++] = r.head[a];
+                }
+            }
+        }
+    }
+
+    free(dist);
+    free(queue);
+    destroy_residual(&r);
+    if (!ok) {
+        printf("Memory allocation failed\n");
+        destroy_flow_result(result);
+        return NULL;
+    }
+    return result;
+}
+
+void destroy_flow_result(flow_result *f) {
+    if (f != NULL) {
+        free(f->flow);
+        free(f->source_side);
+        free(f);
+    }
+}
@@ -0,0 +1,462 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+#include "header.h"
+
+// Edges moved per fread/fwrite while streaming a shard
+#define SHARD_BLOCK 65536
+
+// Shards may exceed an equal split by this factor
+#define PARTITION_SLACK 1.1
+
+#define FENNEL_GAMMA 1.5
+
+// Edge list file: a "numnodes numedges" line, then one "from to" pair per
+// line. Partitioning works best when each node's out-edges are adjacent.
+bool save_edge_list(graph *g, const char *filename) {
+    assert(g != NULL);
+    FILE *f = fopen(filename, "w");
+    if (f == NULL) {
+        return false;
+    }
+    long long m = 0;
+    for (int u = 0; u < g->numnodes; u++) {
+        for (int v = 0; v < g->numnodes; v++) {
+            m += g->edges[u][v];
+        }
+    }
+    bool ok = fprintf(f, "%d %lld\n", g->numnodes, m) > 0;
+    for (int u = 0; ok && u < g->numnodes; u++) {
+        for (int v = 0; ok && v < g->numnodes; v++) {
+            if (g->edges[u][v]) {
+                ok = fprintf(f, "%d %d\n", u, v) > 0;
+            }
+        }
+    }
+    return fclose(f) == 0 && ok;
+}
+
+static char *shard_path(const char *prefix, int shard) {
+    size_t size = strlen(prefix) + 32;
+    char *path = malloc(size);
+    if (path != NULL) {
+        snprintf(path, size, "%s.%d.shard", prefix, shard);
+    }
+    return path;
+}
+
+static shard_set *alloc_shard_set(int numnodes, int numshards, const char *prefix) {
+    shard_set *s = calloc(1, sizeof(*s));
+    if (s == NULL) {
+        return NULL;
+    }
+    s->numnodes = numnodes;
+    s->numshards = numshards;
+    s->part = malloc((numnodes > 0 ? numnodes : 1) * sizeof(int));
+    s->out_degree = calloc(numnodes > 0 ? numnodes : 1, sizeof(int));
+    s->shard_edges = calloc(numshards, sizeof(long long));
+    s->shard_nodes = calloc(numshards, sizeof(int));
+    s->paths = calloc(numshards, sizeof(char *));
+    bool ok = s->part && s->out_degree && s->shard_edges && s->shard_nodes && s->paths;
+    for (int p = 0; ok && p < numshards; p++) {
+        s->paths[p] = shard_path(prefix, p);
+        ok = s->paths[p] != NULL;
+    }
+    if (!ok) {
+        destroy_shard_set(s);
+        return NULL;
+    }
+    for (int v = 0; v < numnodes; v++) {
+        s->part[v] = -1;
+    }
+    return s;
+}
+
+// Streaming placement of 'node' given its out-neighbors: favour the shard
+// holding most already-placed neighbors, discounted by how full it is (LDG
+// scales by the free fraction, Fennel subtracts a marginal size cost).
+static int place_node(shard_set *s, const int *neighbors, int count, partition_method method,
+                      int capacity, double alpha, int *hits) {
+    int k = s->numshards;
+    memset(hits, 0, k * sizeof(int));
+    for (int i = 0; i < count; i++) {
+        if (s->part[neighbors[i]] >= 0) {
+            hits[s->part[neighbors[i]]]++;
+        }
+    }
+    int best = -1;
+    double best_score = 0.0;
+    for (int p = 0; p < k; p++) {
+        if (s->shard_nodes[p] >= capacity) {
+            continue;
+        }
+        double score;
+        if (method == PARTITION_FENNEL) {
+            score = hits[p] - alpha * FENNEL_GAMMA * pow(s->shard_nodes[p], FENNEL_GAMMA - 1.0);
+        } else {
+            score = hits[p] * (1.0 - (double)s->shard_nodes[p] / capacity);
+        }
+        // Ties go to the emptier shard
+        if (best < 0 || score > best_score ||
+            (score == best_score && s->shard_nodes[p] < s->shard_nodes[best])) {
+            best = p;
+            best_score = score;
+        }
+    }
+    return best;
+}
+
+// Assign a node read as a source and append its edges to its shard
+static bool flush_group(shard_set *s, FILE **out, int source, int *neighbors, int count,
+                        partition_method method, int capacity, double alpha, int *hits, int *pairs) {
+    if (s->part[source] < 0) {
+        s->part[source] = place_node(s, neighbors, count, method, capacity, alpha, hits);
+        s->shard_nodes[s->part[source]]++;
+    }
+    int p = s->part[source];
+    s->out_degree[source] += count;
+    s->shard_edges[p] += count;
+    for (int i = 0; i < count; i += SHARD_BLOCK) {
+        int chunk = count - i < SHARD_BLOCK ? count - i : SHARD_BLOCK;
+        for (int j = 0; j < chunk; j++) {
+            pairs[2 * j] = source;
+            pairs[2 * j + 1] = neighbors[i + j];
+        }
+        if (fwrite(pairs, 2 * sizeof(int), chunk, out[p]) != (size_t)chunk) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Split the edge list in 'filename' into 'numshards' binary shard files
+// named "<prefix>.<i>.shard" in a single sequential pass. Nodes are placed
+// by a streaming heuristic the first time they appear as a source; each
+// shard holds the out-edges of its nodes as (from, to) int pairs. Only
+// per-node state stays in memory.
+shard_set *partition_edge_list(const char *filename, const char *prefix, int numshards,
+                               partition_method method) {
+    assert(filename != NULL && prefix != NULL && numshards > 0);
+    FILE *in = fopen(filename, "r");
+    if (in == NULL) {
+        printf("Failed to open %s\n", filename);
+        return NULL;
+    }
+    int n;
+    long long m;
+    if (fscanf(in, "%d %lld", &n, &m) != 2 || n < 0 || m < 0) {
+        printf("Malformed edge list %s\n", filename);
+        fclose(in);
+        return NULL;
+    }
+
+    shard_set *s = alloc_shard_set(n, numshards, prefix);
+    FILE **out = calloc(numshards, sizeof(FILE *));
+    int *hits = malloc(numshards * sizeof(int));
+    int *pairs = malloc(2 * SHARD_BLOCK * sizeof(int));
+    int neighbor_capacity = 16;
+    int *neighbors = malloc(neighbor_capacity * sizeof(int));
+    bool ok = s && out && hits && pairs && neighbors;
+    for (int p = 0; ok && p < numshards; p++) {
+        out[p] = fopen(s->paths[p], "wb");
+        ok = out[p] != NULL;
+    }
+
+    int capacity = (int)ceil(PARTITION_SLACK * n / numshards) + 1;
+    double alpha = n > 0 ? sqrt((double)numshards) * (double)m / pow(n, FENNEL_GAMMA) : 0.0;
+    int source = -1, count = 0, from, to;
+    while (ok && fscanf(in, "%d %d", &from, &to) == 2) {
+        if (from < 0 || from >= n || to < 0 || to >= n) {
+            printf("Edge %d -> %d out of range\n", from, to);
+            ok = false;
+            break;
+        }
+        if (from != source) {
+            if (source >= 0) {
+                ok = flush_group(s, out, source, neighbors, count, method, capacity, alpha, hits, pairs);
+            }
+            source = from;
+            count = 0;
+        }
+        if (count == neighbor_capacity) {
+            int *more = realloc(neighbors, 2 * neighbor_capacity * sizeof(int));
+            if (more == NULL) {
+                ok = false;
+                break;
+            }
+            neighbors = more;
+            neighbor_capacity *= 2;
+        }
+        neighbors[count++] = to;
+    }
+    if (ok && source >= 0) {
+        ok = flush_group(s, out, source, neighbors, count, method, capacity, alpha, hits, pairs);
+    }
+
+    // Nodes that never appeared as a source own no edges; balance them
+    for (int v = 0; ok && v < n; v++) {
+        if (s->part[v] < 0) {
+            int p = 0;
+            for (int q = 1; q < numshards; q++) {
+                if (s->shard_nodes[q] < s->shard_nodes[p]) {
+                    p = q;
+                }
+            }
+            s->part[v] = p;
+            s->shard_nodes[p]++;
+        }
+    }
+
+    for (int p = 0; out != NULL && p < numshards; p++) {
+        if (out[p] != NULL && fclose(out[p]) != 0) {
+            ok = false;
+        }
+    }
+    fclose(in);
+    free(out);
+    free(hits);
+    free(pairs);
+    free(neighbors);
+    if (!ok) {
+        printf("Failed to partition %s\n", filename);
+        if (s != NULL) {
+            delete_shards(s);
+        }
+        destroy_shard_set(s);
+        return NULL;
+    }
+    for (int p = 0; p < numshards; p++) {
+        s->numedges += s->shard_edges[p];
+    }
+    return s;
+}
+
+// Remove the shard files from disk
+void delete_shards(shard_set *s) {
+    for (int p = 0; p < s->numshards; p++) {
+        if (s->paths[p] != NULL) {
+            remove(s->paths[p]);
+        }
+    }
+}
+
+void destroy_shard_set(shard_set *s) {
+    if (s != NULL) {
+        for (int p = 0; s->paths != NULL && p < s->numshards; p++) {
+            free(s->paths[p]);
+        }
+        free(s->paths);
+        free(s->part);
+        free(s->out_degree);
+        free(s->shard_edges);
+        free(s->shard_nodes);
+        free(s);
+    }
+}
+
+// ----------------- Out-of-core kernels -----------------
+
+typedef bool (*edge_visitor)(int from, int to, void *state);
+
+// Stream one shard front to back, handing every edge to 'visit'. Returns
+// false on I/O failure; 'changed' ORs in what the visitor returned.
+static bool stream_shard(shard_set *s, int shard, int *pairs, edge_visitor visit, void *state,
+                         bool *changed) {
+    FILE *f = fopen(s->paths[shard], "rb");
+    if (f == NULL) {
+        return false;
+    }
+    size_t got;
+    while ((got = fread(pairs, 2 * sizeof(int), SHARD_BLOCK, f)) > 0) {
+        for (size_t i = 0; i < got; i++) {
+            if (visit(pairs[2 * i], pairs[2 * i + 1], state)) {
+                *changed = true;
+            }
+        }
+    }
+    bool ok = !ferror(f);
+    fclose(f);
+    return ok;
+}
+
+typedef struct {
+    int *dist;
+    int level;
+    int *next_active;   // frontier nodes found per shard
+    const int *part;
+} bfs_state;
+
+static bool bfs_visit(int from, int to, void *state) {
+    bfs_state *b = state;
+    if (b->dist[from] == b->level && b->dist[to] == INF) {
+        b->dist[to] = b->level + 1;
+        b->next_active[b->part[to]]++;
+        return true;
+    }
+    return false;
+}
+
+// Hop distances from 'start' (INF when unreachable). Each level streams
+// only the shards that own a frontier node, since shards hold out-edges
+// by source.
+int *shard_bfs(shard_set *s, int start) {
+    assert(s != NULL && start >= 0 && start < s->numnodes);
+    int n = s->numnodes, k = s->numshards;
+    int *dist = malloc((n > 0 ? n : 1) * sizeof(int));
+    int *active = calloc(k, sizeof(int));
+    int *next_active = calloc(k, sizeof(int));
+    int *pairs = malloc(2 * SHARD_BLOCK * sizeof(int));
+    bool ok = dist && active && next_active && pairs;
+    for (int v = 0; ok && v < n; v++) {
+        dist[v] = INF;
+    }
+    if (ok) {
+        dist[start] = 0;
+        active[s->part[start]] = 1;
+    }
+
+    bfs_state b = { dist, 0, next_active, s->part };
+    bool changed = ok;
+    while (ok && changed) {
+        changed = false;
+        memset(next_active, 0, k * sizeof(int));
+        for (int p = 0; ok && p < k; p++) {
+            if (active[p] > 0) {
+                ok = stream_shard(s, p, pairs, bfs_visit, &b, &changed);
+            }
+        }
+        memcpy(active, next_active, k * sizeof(int));
+        b.level++;
+    }
+
+    free(active);
+    free(next_active);
+    free(pairs);
+    if (!ok) {
+        printf("Failed to stream shards\n");
+        free(dist);
+        return NULL;
+    }
+    return dist;
+}
+
+static bool component_visit(int from, int to, void *state) {
+    int *label = state;
+    if (label[from] < label[to]) {
+        label[to] = label[from];
+        return true;
+    }
+    if (label[to] < label[from]) {
+        label[from] = label[to];
+        return true;
+    }
+    return false;
+}
+
+// Weakly connected components by min-label propagation, updated in place
+// while streaming so labels travel far within a single pass. Each node gets
+// the smallest id in its component; 'numcomponents' (optional) the count.
+int *shard_connected_components(shard_set *s, int *numcomponents) {
+    assert(s != NULL);
+    int n = s->numnodes;
+    int *label = malloc((n > 0 ? n : 1) * sizeof(int));
+    int *pairs = malloc(2 * SHARD_BLOCK * sizeof(int));
+    bool ok = label && pairs;
+    for (int v = 0; ok && v < n; v++) {
+        label[v] = v;
+    }
+
+    bool changed = ok;
+    while (ok && changed) {
+        changed = false;
+        for (int p = 0; ok && p < s->numshards; p++) {
+            ok = stream_shard(s, p, pairs, component_visit, label, &changed);
+        }
+    }
+    free(pairs);
+    if (!ok) {
+        printf("Failed to stream shards\n");
+        free(label);
+        return NULL;
+    }
+
+    int count = 0;
+    for (int v = 0; v < n; v++) {
+        count += label[v] == v;
+    }
+    if (numcomponents) {
+        *numcomponents = count;
+    }
+    return label;
+}
+
+typedef struct {
+    const double *contrib;
+    double *next;
+} pagerank_state;
+
+static bool pagerank_visit(int from, int to, void *state) {
+    pagerank_state *r = state;
+    r->next[to] += r->contrib[from];
+    return false;
+}
+
+// PageRank with the same model as pagerank() (dangling mass restarts
+// uniformly), pushing contributions along each streamed edge. Memory is
+// three doubles per node regardless of the edge count.
+double *shard_pagerank(shard_set *s, double damping, double tolerance, int max_iterations) {
+    assert(s != NULL);
+    int n = s->numnodes;
+    double *rank = malloc((n > 0 ? n : 1) * sizeof(double));
+    double *next = malloc((n > 0 ? n : 1) * sizeof(double));
+    double *contrib = malloc((n > 0 ? n : 1) * sizeof(double));
+    int *pairs = malloc(2 * SHARD_BLOCK * sizeof(int));
+    bool ok = rank && next && contrib && pairs;
+    for (int v = 0; ok && v < n; v++) {
+        rank[v] = 1.0 / n;
+    }
+
+    pagerank_state r = { contrib, next };
+    for (int iter = 0; ok && iter < max_iterations; iter++) {
+        double dangling = 0.0;
+        for (int u = 0; u < n; u++) {
+            if (s->out_degree[u] == 0) {
+                dangling += rank[u];
+                contrib[u] = 0.0;
+            } else {
+                contrib[u] = rank[u] / s->out_degree[u];
+            }
+            next[u] = 0.0;
+        }
+        bool unused = false;
+        for (int p = 0; ok && p < s->numshards; p++) {
+            ok = stream_shard(s, p, pairs, pagerank_visit, &r, &unused);
+        }
+
+        double restart = ((1.0 - damping) + damping * dangling) / n;
+        double diff = 0.0;
+        for (int v = 0; v < n; v++) {
+            next[v] = damping * next[v] + restart;
+            diff += fabs(next[v] - rank[v]);
+        }
+        double *tmp = rank;
+        rank = next;
+        next = tmp;
+        r.next = next;
+        if (diff < tolerance) {
+            break;
+        }
+    }
+
+    free(next);
+    free(contrib);
+    free(pairs);
+    if (!ok) {
+        printf("Failed to stream shards\n");
+        free(rank);
+        return NULL;
+    }
+    return rank;
+}
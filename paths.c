@@ -0,0 +1,400 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "header.h"
+
+// Every search records each improvement as a label pointing at the label it
+// was reached from, so a path can be read back even after the node at its
+// end has been improved again (hop-limited searches keep both).
+
+search_workspace *create_search_workspace(int numnodes) {
+    search_workspace *ws = calloc(1, sizeof(*ws));
+    if (ws == NULL) {
+        return NULL;
+    }
+    int n = numnodes > 0 ? numnodes : 1;
+    ws->numnodes = numnodes;
+    ws->dist = malloc(n * sizeof(int));
+    ws->label = malloc(n * sizeof(int));
+    ws->touched = malloc(n * sizeof(int));
+    ws->frontier = malloc(n * sizeof(int));
+    ws->blocked = calloc(n, sizeof(unsigned char));
+    ws->queue = create_min_heap(numnodes);
+    ws->labelcapacity = n;
+    ws->labels = malloc(ws->labelcapacity * sizeof(path_label));
+    if (ws->dist == NULL || ws->label == NULL || ws->touched == NULL || ws->frontier == NULL ||
+        ws->blocked == NULL || ws->queue == NULL || ws->labels == NULL) {
+        destroy_search_workspace(ws);
+        return NULL;
+    }
+    for (int v = 0; v < numnodes; v++) {
+        ws->dist[v] = INF;
+    }
+    return ws;
+}
+
+void destroy_search_workspace(search_workspace *ws) {
+    if (ws != NULL) {
+        free(ws->dist);
+        free(ws->label);
+        free(ws->touched);
+        free(ws->frontier);
+        free(ws->blocked);
+        free(ws->labels);
+        destroy_min_heap(ws->queue);
+        free(ws);
+    }
+}
+
+// Forget the previous search, touching only what it reached
+static void reset_search(search_workspace *ws) {
+    for (int i = 0; i < ws->numtouched; i++) {
+        ws->dist[ws->touched[i]] = INF;
+    }
+    ws->numtouched = 0;
+    ws->numlabels = 0;
+    heap_clear(ws->queue);
+}
+
+// Make v's best entry a new label; returns false when out of memory
+static bool record_label(search_workspace *ws, int v, int parent, int dist, int hops) {
+    if (ws->numlabels == ws->labelcapacity) {
+        int capacity = ws->labelcapacity * 2;
+        path_label *labels = realloc(ws->labels, capacity * sizeof(path_label));
+        if (labels == NULL) {
+            return false;
+        }
+        ws->labels = labels;
+        ws->labelcapacity = capacity;
+    }
+    if (ws->dist[v] == INF) {
+        ws->touched[ws->numtouched++] = v;
+    }
+    ws->labels[ws->numlabels] = (path_label){ v, parent, dist, hops };
+    ws->label[v] = ws->numlabels++;
+    ws->dist[v] = dist;
+    return true;
+}
+
+// Breadth-first search that stops after 'max_hops' levels (no limit when
+// negative). Returns how many nodes were reached; they are listed in BFS
+// order in ws->touched with their hop counts in ws->dist.
+int bounded_bfs(csr_graph *c, int source, int max_hops, search_workspace *ws) {
+    assert(c != NULL && ws != NULL && source >= 0 && source < c->numnodes);
+    reset_search(ws);
+    if (!record_label(ws, source, -1, 0, 0)) {
+        return -1;
+    }
+    for (int head = 0; head < ws->numtouched; head++) {
+        int u = ws->touched[head];
+        int du = ws->dist[u];
+        if (du == max_hops) {
+            break;      // BFS order: everything after is this deep too
+        }
+        for (int k = c->offsets[u]; k < c->offsets[u + 1]; k++) {
+            int v = c->targets[k];
+            if (ws->dist[v] == INF && !ws->blocked[v] && !record_label(ws, v, ws->label[u], du + 1, du + 1)) {
+                return -1;
+            }
+        }
+    }
+    return ws->numtouched;
+}
+
+// Label-setting Dijkstra with early exit at 'target' and at 'max_distance'.
+// Arcs from 'source' to any node in 'banned' are skipped (Yen spur paths).
+static int heap_search(csr_graph *c, int source, int target, int max_distance,
+                       search_workspace *ws, const int *banned, int numbanned) {
+    if (!record_label(ws, source, -1, 0, 0)) {
+        return -1;
+    }
+    heap_push(ws->queue, source, 0);
+    while (ws->queue->size > 0) {
+        int u = heap_pop(ws->queue);
+        if (u == target) {
+            break;
+        }
+        int du = ws->dist[u];
+        int from = ws->label[u];
+        int hops = ws->labels[from].hops + 1;
+        for (int k = c->offsets[u]; k < c->offsets[u + 1]; k++) {
+            int v = c->targets[k];
+            int alt = du + (c->weights ? c->weights[k] : 1);
+            if (alt >= ws->dist[v] || alt > max_distance || ws->blocked[v]) {
+                continue;
+            }
+            bool skip = false;
+            for (int b = 0; u == source && b < numbanned; b++) {
+                skip = skip || banned[b] == v;
+            }
+            if (skip) {
+                continue;
+            }
+            if (!record_label(ws, v, from, alt, hops)) {
+                return -1;
+            }
+            heap_push(ws->queue, v, alt);
+        }
+    }
+    return ws->numtouched;
+}
+
+// Bellman-Ford by hop layers: round r extends the labels improved in round
+// r - 1, so after 'max_hops' rounds every distance is the shortest over
+// paths of at most that many edges. A label improved again in the same
+// round is dominated and skipped; one improved in a later round has fewer
+// hops and still counts.
+static int layered_search(csr_graph *c, int source, int target, int max_hops, int max_distance,
+                          search_workspace *ws) {
+    if (!record_label(ws, source, -1, 0, 0)) {
+        return -1;
+    }
+    int count = 0;
+    ws->frontier[count++] = 0;
+    for (int round = 1; round <= max_hops && count > 0; round++) {
+        int first = ws->numlabels;
+        for (int i = 0; i < count; i++) {
+            path_label from = ws->labels[ws->frontier[i]];
+            int current = ws->label[from.node];
+            if (current != ws->frontier[i] && ws->labels[current].hops == from.hops) {
+                continue;
+            }
+            // Nothing longer than the best route to the target is useful
+            int cutoff = target >= 0 && ws->dist[target] < max_distance ? ws->dist[target] - 1 : max_distance;
+            for (int k = c->offsets[from.node]; k < c->offsets[from.node + 1]; k++) {
+                int v = c->targets[k];
+                int alt = from.dist + (c->weights ? c->weights[k] : 1);
+                if (alt < ws->dist[v] && alt <= cutoff && !ws->blocked[v] &&
+                    !record_label(ws, v, ws->frontier[i], alt, round)) {
+                    return -1;
+                }
+            }
+        }
+        // This round's labels that are still the best of their node
+        count = 0;
+        for (int l = first; l < ws->numlabels; l++) {
+            if (ws->label[ws->labels[l].node] == l && count < ws->numnodes) {
+                ws->frontier[count++] = l;
+            }
+        }
+    }
+    return ws->numtouched;
+}
+
+// Shortest distances from 'source' that stop early: at 'target' once it is
+// settled (-1 for none), past 'max_distance' (INF for none), and beyond
+// 'max_hops' edges (negative for none). Returns how many nodes were
+// reached, listed in ws->touched with distances in ws->dist; -1 when out
+// of memory. Read paths back with search_path.
+int bounded_dijkstra(csr_graph *c, int source, int target, int max_hops, int max_distance,
+                     search_workspace *ws) {
+    assert(c != NULL && ws != NULL && source >= 0 && source < c->numnodes);
+    assert(target < c->numnodes);
+    reset_search(ws);
+    if (max_hops < 0) {
+        return heap_search(c, source, target, max_distance, ws, NULL, 0);
+    }
+    return layered_search(c, source, target, max_hops, max_distance, ws);
+}
+
+// Nodes of the path the last search found to 'node', source first, written
+// to 'path' (room for the hop count + 1). Returns the number of nodes, 0
+// if 'node' was not reached.
+int search_path(search_workspace *ws, int node, int *path) {
+    assert(ws != NULL && path != NULL);
+    if (ws->dist[node] == INF) {
+        return 0;
+    }
+    int count = ws->labels[ws->label[node]].hops + 1;
+    int i = count;
+    for (int l = ws->label[node]; l >= 0; l = ws->labels[l].parent) {
+        path[--i] = ws->labels[l].node;
+    }
+    return count;
+}
+
+// Same path as predecessor links, as print_path expects; only entries on
+// the path are written
+void search_predecessors(search_workspace *ws, int node, int *predecessors) {
+    assert(ws != NULL && predecessors != NULL);
+    if (ws->dist[node] == INF) {
+        predecessors[node] = -1;
+        return;
+    }
+    for (int l = ws->label[node]; l >= 0; l = ws->labels[l].parent) {
+        int parent = ws->labels[l].parent;
+        predecessors[ws->labels[l].node] = parent >= 0 ? ws->labels[parent].node : -1;
+    }
+}
+
+// ----------------- Yen's k shortest loopless paths -----------------
+
+typedef struct {
+    int cost;
+    int length;
+    int *nodes;
+} candidate_path;
+
+// Lightest arc u->v (rows are sorted, parallel arcs are adjacent)
+static int arc_weight(csr_graph *c, int u, int v) {
+    int lo = c->offsets[u], hi = c->offsets[u + 1];
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (c->targets[mid] < v) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    int best = INF;
+    for (; lo < c->offsets[u + 1] && c->targets[lo] == v; lo++) {
+        int w = c->weights ? c->weights[lo] : 1;
+        if (w < best) {
+            best = w;
+        }
+    }
+    return best;
+}
+
+static bool same_nodes(const int *a, int alen, const int *b, int blen) {
+    return alen == blen && memcmp(a, b, alen * sizeof(int)) == 0;
+}
+
+static bool append_path(path_set *p, const int *nodes, int length, int cost, int *capacity) {
+    if (p->offsets[p->count] + length > *capacity) {
+        int grown = (*capacity + length) * 2;
+        int *more = realloc(p->nodes, grown * sizeof(int));
+        if (more == NULL) {
+            return false;
+        }
+        p->nodes = more;
+        *capacity = grown;
+    }
+    memcpy(p->nodes + p->offsets[p->count], nodes, length * sizeof(int));
+    p->lengths[p->count] = cost;
+    p->offsets[p->count + 1] = p->offsets[p->count] + length;
+    p->count++;
+    return true;
+}
+
+// Up to 'k' loopless paths from 'source' to 'target' in order of total
+// weight (Yen). Each spur search reuses 'ws', blocks the root path's nodes
+// and exits as soon as the target settles. Fewer than 'k' paths are
+// returned when no more exist.
+path_set *k_shortest_paths(csr_graph *c, int source, int target, int k, search_workspace *ws) {
+    assert(c != NULL && ws != NULL);
+    assert(source >= 0 && source < c->numnodes && target >= 0 && target < c->numnodes);
+    int n = c->numnodes;
+    path_set *p = calloc(1, sizeof(*p));
+    int *spur_path = malloc((n > 0 ? n : 1) * sizeof(int));
+    int *banned = malloc((k > 0 ? k : 1) * sizeof(int));
+    if (p != NULL) {
+        p->lengths = malloc((k > 0 ? k : 1) * sizeof(int));
+        p->offsets = calloc(k + 1, sizeof(int));
+    }
+    int capacity = 0;
+    candidate_path *candidates = NULL;
+    int numcandidates = 0, candidatecapacity = 0;
+    bool ok = p && spur_path && banned && p->lengths && p->offsets;
+
+    if (ok && k > 0) {
+        reset_search(ws);
+        ok = heap_search(c, source, target, INF, ws, NULL, 0) >= 0;
+        if (ok && ws->dist[target] != INF) {
+            int length = search_path(ws, target, spur_path);
+            ok = append_path(p, spur_path, length, ws->dist[target], &capacity);
+        }
+    }
+
+    while (ok && p->count > 0 && p->count < k) {
+        const int *last = p->nodes + p->offsets[p->count - 1];
+        int lastlength = p->offsets[p->count] - p->offsets[p->count - 1];
+        int rootcost = 0;
+
+        for (int j = 0; ok && j < lastlength - 1; j++) {
+            int spur = last[j];
+            // Arcs leaving the spur that earlier paths with this root used
+            int numbanned = 0;
+            for (int a = 0; a < p->count; a++) {
+                const int *other = p->nodes + p->offsets[a];
+                int otherlength = p->offsets[a + 1] - p->offsets[a];
+                if (otherlength > j + 1 && memcmp(other, last, (j + 1) * sizeof(int)) == 0) {
+                    banned[numbanned++] = other[j + 1];
+                }
+            }
+            for (int r = 0; r < j; r++) {
+                ws->blocked[last[r]] = 1;
+            }
+
+            reset_search(ws);
+            ok = heap_search(c, spur, target, INF, ws, banned, numbanned) >= 0;
+            for (int r = 0; r < j; r++) {
+                ws->blocked[last[r]] = 0;
+            }
+
+            if (ok && ws->dist[target] != INF) {
+                int spurlength = search_path(ws, target, spur_path);
+                int length = j + spurlength;
+                int cost = rootcost + ws->dist[target];
+                bool seen = false;
+                for (int a = 0; a < numcandidates && !seen; a++) {
+                    seen = candidates[a].cost == cost && candidates[a].length == length &&
+                           same_nodes(candidates[a].nodes, j, last, j) &&
+                           same_nodes(candidates[a].nodes + j, spurlength, spur_path, spurlength);
+                }
+                if (!seen) {
+                    if (numcandidates == candidatecapacity) {
+                        candidatecapacity = candidatecapacity ? candidatecapacity * 2 : 8;
+                        candidate_path *more = realloc(candidates, candidatecapacity * sizeof(candidate_path));
+                        ok = more != NULL;
+                        candidates = ok ? more : candidates;
+                    }
+                    int *nodes = ok ? malloc(length * sizeof(int)) : NULL;
+                    ok = ok && nodes != NULL;
+                    if (ok) {
+                        memcpy(nodes, last, j * sizeof(int));
+                        memcpy(nodes + j, spur_path, spurlength * sizeof(int));
+                        candidates[numcandidates++] = (candidate_path){ cost, length, nodes };
+                    }
+                }
+            }
+            rootcost += arc_weight(c, spur, last[j + 1]);
+        }
+        if (!ok || numcandidates == 0) {
+            break;
+        }
+
+        int best = 0;
+        for (int a = 1; a < numcandidates; a++) {
+            if (candidates[a].cost < candidates[best].cost) {
+                best = a;
+            }
+        }
+        ok = append_path(p, candidates[best].nodes, candidates[best].length, candidates[best].cost, &capacity);
+        free(candidates[best].nodes);
+        candidates[best] = candidates[--numcandidates];
+    }
+
+    for (int a = 0; a < numcandidates; a++) {
+        free(candidates[a].nodes);
+    }
+    free(candidates);
+    free(spur_path);
+    free(banned);
+    if (!ok) {
+        printf("Memory allocation failed\n");
+        destroy_path_set(p);
+        return NULL;
+    }
+    return p;
+}
+
+void destroy_path_set(path_set *p) {
+    if (p != NULL) {
+        free(p->lengths);
+        free(p->offsets);
+        free(p->nodes);
+        free(p);
+    }
+}
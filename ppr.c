@@ -0,0 +1,246 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include "header.h"
+
+// Scratch space for local personalized PageRank queries. Arrays are sized
+// for the whole graph once; each query only clears the entries the previous
+// query touched, so per-query cost depends on the neighborhood, not on V.
+ppr_workspace *create_ppr_workspace(int numnodes) {
+    ppr_workspace *w = malloc(sizeof(*w));
+    if (w == NULL) {
+        return NULL;
+    }
+    w->numnodes = numnodes;
+    w->numtouched = 0;
+    w->estimate = calloc(numnodes, sizeof(double));
+    w->residual = calloc(numnodes, sizeof(double));
+    w->touched = malloc(numnodes * sizeof(int));
+    w->is_touched = calloc(numnodes, sizeof(bool));
+    w->queue = malloc(numnodes * sizeof(int));
+    w->queued = calloc(numnodes, sizeof(bool));
+    if (!w->estimate || !w->residual || !w->touched || !w->is_touched || !w->queue || !w->queued) {
+        destroy_ppr_workspace(w);
+        return NULL;
+    }
+    return w;
+}
+
+void destroy_ppr_workspace(ppr_workspace *w) {
+    if (w != NULL) {
+        free(w->estimate);
+        free(w->residual);
+        free(w->touched);
+        free(w->is_touched);
+        free(w->queue);
+        free(w->queued);
+        free(w);
+    }
+}
+
+// Clear only what the last query wrote
+static void reset_workspace(ppr_workspace *w) {
+    for (int i = 0; i < w->numtouched; i++) {
+        int v = w->touched[i];
+        w->estimate[v] = 0.0;
+        w->residual[v] = 0.0;
+        w->is_touched[v] = false;
+        w->queued[v] = false;
+    }
+    w->numtouched = 0;
+}
+
+static void touch(ppr_workspace *w, int v) {
+    if (!w->is_touched[v]) {
+        w->is_touched[v] = true;
+        w->touched[w->numtouched++] = v;
+    }
+}
+
+static int out_degree(csr_graph *c, int v) {
+    return c->offsets[v + 1] - c->offsets[v];
+}
+
+// Forward push (Andersen-Chung-Lang). Leaves estimate[] within
+// epsilon * deg(v) of the true personalized PageRank of 'source' with
+// restart probability 'alpha'. Total work is O(1 / (alpha * epsilon))
+// regardless of graph size. Returns the number of touched nodes.
+int ppr_push(csr_graph *c, int source, double alpha, double epsilon, ppr_workspace *w) {
+    assert(c != NULL && w != NULL);
+    assert(source >= 0 && source < c->numnodes);
+    assert(alpha > 0.0 && alpha <= 1.0 && epsilon > 0.0);
+
+    reset_workspace(w);
+    touch(w, source);
+    w->residual[source] = 1.0;
+
+    // The queue is circular: a node is in it at most once at a time
+    int n = c->numnodes;
+    int front = 0, count = 0;
+    w->queue[0] = source;
+    w->queued[source] = true;
+    count = 1;
+
+    while (count > 0) {
+        int u = w->queue[front];
+        front = (front + 1) % n;
+        count--;
+        w->queued[u] = false;
+
+        int deg = out_degree(c, u);
+        double r = w->residual[u];
+        w->residual[u] = 0.0;
+        w->estimate[u] += alpha * r;
+
+        // Dangling nodes send their walks back to the source, matching the
+        // restart vector used by personalized_pagerank
+        int first = deg > 0 ? c->offsets[u] : 0;
+        int last = deg > 0 ? c->offsets[u + 1] : 1;
+        double share = (1.0 - alpha) * r / (last - first);
+        for (int k = first; k < last; k++) {
+            int v = deg > 0 ? c->targets[k] : source;
+            touch(w, v);
+            w->residual[v] += share;
+            int vdeg = out_degree(c, v);
+            if (!w->queued[v] && w->residual[v] >= epsilon * (vdeg > 0 ? vdeg : 1)) {
+                w->queue[(front + count) % n] = v;
+                w->queued[v] = true;
+                count++;
+            }
+        }
+    }
+    return w->numtouched;
+}
+
+// Walk from 'start' until it stops (probability alpha per step); dangling
+// nodes jump back to 'source'. Returns the node the walk stopped at.
+static int random_walk(csr_graph *c, int source, int start, double alpha, unsigned long long *state) {
+    int u = start;
+    while (next_random(state) >= alpha * 4294967296.0) {
+        int deg = out_degree(c, u);
+        u = deg > 0 ? c->targets[c->offsets[u] + next_random(state) % deg] : source;
+    }
+    return u;
+}
+
+// Monte Carlo estimate from 'walks' random walks started at 'source'.
+// Expected work is walks / alpha steps. Returns the number of touched nodes.
+int ppr_monte_carlo(csr_graph *c, int source, double alpha, int walks,
+                    unsigned long long seed, ppr_workspace *w) {
+    assert(c != NULL && w != NULL);
+    assert(source >= 0 && source < c->numnodes);
+    assert(alpha > 0.0 && alpha <= 1.0 && walks > 0);
+
+    reset_workspace(w);
+    unsigned long long state = seed ? seed : 1;
+    double weight = 1.0 / walks;
+    for (int i = 0; i < walks; i++) {
+        int end = random_walk(c, source, source, alpha, &state);
+        touch(w, end);
+        w->estimate[end] += weight;
+    }
+    return w->numtouched;
+}
+
+// Push first, then spend random walks only on the leftover residual mass.
+// Gives Monte Carlo accuracy at a fraction of the walks for the same epsilon.
+int ppr_push_walk(csr_graph *c, int source, double alpha, double epsilon, int walks,
+                  unsigned long long seed, ppr_workspace *w) {
+    ppr_push(c, source, alpha, epsilon, w);
+
+    unsigned long long state = seed ? seed : 1;
+    int pushed = w->numtouched;
+    for (int i = 0; i < pushed; i++) {
+        int u = w->touched[i];
+        double r = w->residual[u];
+        if (r <= 0.0) {
+            continue;
+        }
+        w->residual[u] = 0.0;
+        int count = (int)(r * walks) + 1;
+        double weight = r / count;
+        for (int j = 0; j < count; j++) {
+            int end = random_walk(c, source, u, alpha, &state);
+            touch(w, end);
+            w->estimate[end] += weight;
+        }
+    }
+    return w->numtouched;
+}
+
+static bool csr_has_edge(csr_graph *c, int from, int to) {
+    int lo = c->offsets[from], hi = c->offsets[from + 1];
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (c->targets[mid] < to) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo < c->offsets[from + 1] && c->targets[lo] == to;
+}
+
+// Top 'k' personalized PageRank candidates for 'user' that are not already
+// its out-neighbors, written best first into 'out'. Scores are read from the
+// workspace filled by ppr_push / ppr_monte_carlo / ppr_push_walk.
+int ppr_top_candidates(csr_graph *c, int user, int k, ppr_workspace *w, int *out) {
+    int found = 0;
+    for (int i = 0; i < w->numtouched; i++) {
+        int v = w->touched[i];
+        if (v == user || w->estimate[v] <= 0.0 || csr_has_edge(c, user, v)) {
+            continue;
+        }
+        // Insertion into the small sorted result array
+        int pos = found < k ? found++ : k;
+        while (pos > 0 && w->estimate[out[pos - 1]] < w->estimate[v]) {
+            if (pos < k) {
+                out[pos] = out[pos - 1];
+            }
+            pos--;
+        }
+        if (pos < k) {
+            out[pos] = v;
+        }
+    }
+    return found;
+}
+
+// Print the top 'k' personalized PageRank recommendations for 'user'. The
+// CSR view and the workspace are built on first use and kept by the caller
+// across queries; the view must be dropped (destroyed and set to NULL)
+// whenever the network changes. A query then only pays for the push
+// around the user, which is bounded by the tolerance rather than by V.
+void recommend_friends_ppr(graph *g, csr_graph **view, ppr_workspace **workspace, int user,
+                           int k, recommend_mode mode) {
+    assert(g != NULL && view != NULL && workspace != NULL && k > 0);
+    if (*view == NULL) {
+        *view = build_csr(g);
+    }
+    if (*workspace == NULL) {
+        *workspace = create_ppr_workspace(g->numnodes);
+    }
+    int *candidates = malloc(k * sizeof(int));
+    if (*view == NULL || *workspace == NULL || candidates == NULL) {
+        printf("Failed to compute recommendations.\n");
+        free(candidates);
+        return;
+    }
+
+    csr_graph *c = *view;
+    ppr_workspace *w = *workspace;
+    if (mode == RECOMMEND_PPR_WALK) {
+        ppr_push_walk(c, user, 0.15, 1e-4, 1000, 1, w);
+    } else {
+        ppr_push(c, user, 0.15, 1e-6, w);
+    }
+
+    int found = ppr_top_candidates(c, user, k, w, candidates);
+    for (int i = 0; i < found; i++) {
+        printf("Recommend User %d (score %.4f)\n", candidates[i], w->estimate[candidates[i]]);
+    }
+    if (found == 0) {
+        printf("No friend recommendations available for User %d.\n", user);
+    }
+    free(candidates);
+}
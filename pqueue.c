@@ -0,0 +1,114 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include "header.h"
+
+// Indexed binary min-heap over node ids with decrease-key. position[] makes
+// every node findable in O(1); clearing only touches what is still queued.
+min_heap *create_min_heap(int numnodes) {
+    min_heap *h = malloc(sizeof(*h));
+    if (h == NULL) {
+        return NULL;
+    }
+    h->size = 0;
+    h->nodes = malloc((numnodes > 0 ? numnodes : 1) * sizeof(int));
+    h->keys = malloc((numnodes > 0 ? numnodes : 1) * sizeof(int));
+    h->position = malloc((numnodes > 0 ? numnodes : 1) * sizeof(int));
+    if (h->nodes == NULL || h->keys == NULL || h->position == NULL) {
+        destroy_min_heap(h);
+        return NULL;
+    }
+    for (int i = 0; i < numnodes; i++) {
+        h->position[i] = -1;
+    }
+    return h;
+}
+
+void destroy_min_heap(min_heap *h) {
+    if (h != NULL) {
+        free(h->nodes);
+        free(h->keys);
+        free(h->position);
+        free(h);
+    }
+}
+
+void heap_clear(min_heap *h) {
+    for (int i = 0; i < h->size; i++) {
+        h->position[h->nodes[i]] = -1;
+    }
+    h->size = 0;
+}
+
+static void heap_place(min_heap *h, int i, int node) {
+    h->nodes[i] = node;
+    h->position[node] = i;
+}
+
+static void sift_up(min_heap *h, int i) {
+    int node = h->nodes[i];
+    int key = h->keys[node];
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (h->keys[h->nodes[parent]] <= key) {
+            break;
+        }
+        heap_place(h, i, h->nodes[parent]);
+        i = parent;
+    }
+    heap_place(h, i, node);
+}
+
+static void sift_down(min_heap *h, int i) {
+    int node = h->nodes[i];
+    int key = h->keys[node];
+    for (;;) {
+        int child = 2 * i + 1;
+        if (child >= h->size) {
+            break;
+        }
+        if (child + 1 < h->size && h->keys[h->nodes[child + 1]] < h->keys[h->nodes[child]]) {
+            child++;
+        }
+        if (h->keys[h->nodes[child]] >= key) {
+            break;
+        }
+        heap_place(h, i, h->nodes[child]);
+        i = child;
+    }
+    heap_place(h, i, node);
+}
+
+// Insert 'node' with 'key', or lower its key if it is queued with a larger
+// one. Returns false (and changes nothing) if the queued key is not larger.
+bool heap_push(min_heap *h, int node, int key) {
+    int i = h->position[node];
+    if (i >= 0) {
+        if (h->keys[node] <= key) {
+            return false;
+        }
+        h->keys[node] = key;
+        sift_up(h, i);
+        return true;
+    }
+    h->keys[node] = key;
+    h->nodes[h->size] = node;
+    h->position[node] = h->size;
+    h->size++;
+    sift_up(h, h->size - 1);
+    return true;
+}
+
+// Remove and return the node with the smallest key; its key stays readable
+// in h->keys[node]
+int heap_pop(min_heap *h) {
+    assert(h->size > 0);
+    int top = h->nodes[0];
+    h->position[top] = -1;
+    h->size--;
+    if (h->size > 0) {
+        heap_place(h, 0, h->nodes[h->size]);
+        sift_down(h, 0);
+    }
+    return top;
+}
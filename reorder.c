@@ -0,0 +1,456 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <assert.h>
+#include "header.h"
+
+// All orderings return perm[old_id] = new_id, a bijection on 0 .. numnodes-1.
+
+static int *alloc_ids(int n) {
+    int *ids = malloc((n > 0 ? n : 1) * sizeof(int));
+    if (ids == NULL) {
+        printf("Memory allocation failed\n");
+    }
+    return ids;
+}
+
+// perm from a list of old ids in their new order
+static void order_to_perm(const int *order, int *perm, int n) {
+    for (int i = 0; i < n; i++) {
+        perm[order[i]] = i;
+    }
+}
+
+int *invert_permutation(const int *perm, int n) {
+    int *inverse = alloc_ids(n);
+    if (inverse == NULL) {
+        return NULL;
+    }
+    for (int i = 0; i < n; i++) {
+        inverse[perm[i]] = i;
+    }
+    return inverse;
+}
+
+static int degree_of(csr_graph *c, int v) {
+    return c->offsets[v + 1] - c->offsets[v];
+}
+
+static int max_degree(csr_graph *c) {
+    int maxdeg = 0;
+    for (int v = 0; v < c->numnodes; v++) {
+        if (degree_of(c, v) > maxdeg) {
+            maxdeg = degree_of(c, v);
+        }
+    }
+    return maxdeg;
+}
+
+// Row entries sorted with qsort by key, then value
+typedef struct {
+    int key;
+    int value;
+} key_pair;
+
+static int compare_pairs(const void *a, const void *b) {
+    const key_pair *x = a, *y = b;
+    if (x->key != y->key) {
+        return (x->key > y->key) - (x->key < y->key);
+    }
+    return (x->value > y->value) - (x->value < y->value);
+}
+
+// Stable counting sort of node ids by decreasing degree
+static int *sort_by_degree(csr_graph *c) {
+    int n = c->numnodes;
+    int maxdeg = max_degree(c);
+    int *start = calloc(maxdeg + 2, sizeof(int));
+    int *order = alloc_ids(n);
+    if (start == NULL || order == NULL) {
+        free(start);
+        free(order);
+        return NULL;
+    }
+    for (int v = 0; v < n; v++) {
+        start[maxdeg - degree_of(c, v) + 1]++;
+    }
+    for (int d = 0; d <= maxdeg; d++) {
+        start[d + 1] += start[d];
+    }
+    for (int v = 0; v < n; v++) {
+        order[start[maxdeg - degree_of(c, v)]++] = v;
+    }
+    free(start);
+    return order;
+}
+
+// Highest-degree nodes get the smallest ids, so hub rows share cache lines
+int *order_by_degree(graph *g) {
+    assert(g != NULL);
+    csr_graph *c = build_csr_undirected(g);
+    int *perm = alloc_ids(g->numnodes);
+    int *order = c ? sort_by_degree(c) : NULL;
+    if (order == NULL || perm == NULL) {
+        destroy_csr(c);
+        free(order);
+        free(perm);
+        return NULL;
+    }
+    order_to_perm(order, perm, g->numnodes);
+    destroy_csr(c);
+    free(order);
+    return perm;
+}
+
+// Hub clustering: nodes with above-average degree are packed at the front,
+// everything keeps its original relative order. Cheaper than a full sort
+// and preserves whatever locality the input ids already had.
+int *order_hub_cluster(graph *g) {
+    assert(g != NULL);
+    int n = g->numnodes;
+    csr_graph *c = build_csr_undirected(g);
+    int *perm = alloc_ids(n);
+    if (c == NULL || perm == NULL) {
+        destroy_csr(c);
+        free(perm);
+        return NULL;
+    }
+
+    double average = n > 0 ? (double)c->numedges / n : 0.0;
+    int next = 0;
+    for (int v = 0; v < n; v++) {
+        if (degree_of(c, v) > average) {
+            perm[v] = next++;
+        }
+    }
+    for (int v = 0; v < n; v++) {
+        if (degree_of(c, v) <= average) {
+            perm[v] = next++;
+        }
+    }
+    destroy_csr(c);
+    return perm;
+}
+
+// Reverse Cuthill-McKee: BFS from a minimum-degree node of each component,
+// visiting neighbors by increasing degree, then reverse. Reduces the
+// bandwidth of the adjacency matrix so neighbors get nearby ids.
+int *order_rcm(graph *g) {
+    assert(g != NULL);
+    int n = g->numnodes;
+    csr_graph *c = build_csr_undirected(g);
+    int *perm = alloc_ids(n);
+    int *order = alloc_ids(n);
+    bool *visited = calloc(n > 0 ? n : 1, sizeof(bool));
+    int *by_degree = c ? sort_by_degree(c) : NULL;
+    key_pair *queued = c ? malloc((max_degree(c) + 1) * sizeof(key_pair)) : NULL;
+    if (!c || !perm || !order || !visited || !by_degree || !queued) {
+        destroy_csr(c);
+        free(perm);
+        free(order);
+        free(visited);
+        free(by_degree);
+        free(queued);
+        return NULL;
+    }
+
+    int rear = 0;
+    // by_degree is decreasing, so scan it backwards for component roots
+    for (int r = n - 1; r >= 0; r--) {
+        int root = by_degree[r];
+        if (visited[root]) {
+            continue;
+        }
+        int front = rear;
+        visited[root] = true;
+        order[rear++] = root;
+        while (front < rear) {
+            int u = order[front++];
+            int first = rear;
+            for (int k = c->offsets[u]; k < c->offsets[u + 1]; k++) {
+                int v = c->targets[k];
+                if (!visited[v]) {
+                    visited[v] = true;
+                    order[rear++] = v;
+                }
+            }
+            // Newly queued neighbors by degree, ties by id
+            for (int i = first; i < rear; i++) {
+                queued[i - first] = (key_pair){ degree_of(c, order[i]), order[i] };
+            }
+            qsort(queued, rear - first, sizeof(key_pair), compare_pairs);
+            for (int i = first; i < rear; i++) {
+                order[i] = queued[i - first].value;
+            }
+        }
+    }
+
+    for (int i = 0; i < n; i++) {
+        perm[order[i]] = n - 1 - i;
+    }
+    destroy_csr(c);
+    free(order);
+    free(visited);
+    free(by_degree);
+    free(queued);
+    return perm;
+}
+
+// Bucket priority queue for Gorder: scores only ever change by one, so
+// nodes move between neighboring buckets in O(1).
+typedef struct {
+    int *key;
+    int *next;
+    int *prev;
+    int *head;
+    int numbuckets;
+    int top;
+} unit_heap;
+
+static void heap_unlink(unit_heap *h, int v) {
+    if (h->prev[v] >= 0) {
+        h->next[h->prev[v]] = h->next[v];
+    } else {
+        h->head[h->key[v]] = h->next[v];
+    }
+    if (h->next[v] >= 0) {
+        h->prev[h->next[v]] = h->prev[v];
+    }
+}
+
+static bool heap_link(unit_heap *h, int v) {
+    int k = h->key[v];
+    if (k >= h->numbuckets) {
+        int size = h->numbuckets * 2;
+        int *head = realloc(h->head, size * sizeof(int));
+        if (head == NULL) {
+            return false;
+        }
+        for (int i = h->numbuckets; i < size; i++) {
+            head[i] = -1;
+        }
+        h->head = head;
+        h->numbuckets = size;
+    }
+    h->prev[v] = -1;
+    h->next[v] = h->head[k];
+    if (h->head[k] >= 0) {
+        h->prev[h->head[k]] = v;
+    }
+    h->head[k] = v;
+    if (k > h->top) {
+        h->top = k;
+    }
+    return true;
+}
+
+static bool heap_adjust(unit_heap *h, int v, int delta) {
+    heap_unlink(h, v);
+    h->key[v] += delta;
+    return heap_link(h, v);
+}
+
+static int heap_pop_max(unit_heap *h) {
+    while (h->top > 0 && h->head[h->top] < 0) {
+        h->top--;
+    }
+    int v = h->head[h->top];
+    if (v >= 0) {
+        heap_unlink(h, v);
+    }
+    return v;
+}
+
+// Add 'delta' to the score of every unplaced node that would share a cache
+// window with 'v': its direct neighbors and its siblings (nodes with a common
+// in-neighbor). In-neighbors above 'hub_limit' out-degree are skipped, as in
+// the original Gorder, to bound the work.
+static bool gorder_update(unit_heap *h, csr_graph *out, csr_graph *in, const bool *placed,
+                          int v, int delta, int hub_limit) {
+    for (int k = out->offsets[v]; k < out->offsets[v + 1]; k++) {
+        int u = out->targets[k];
+        if (!placed[u] && !heap_adjust(h, u, delta)) {
+            return false;
+        }
+    }
+    for (int k = in->offsets[v]; k < in->offsets[v + 1]; k++) {
+        int w = in->targets[k];
+        if (!placed[w] && !heap_adjust(h, w, delta)) {
+            return false;
+        }
+        if (out->offsets[w + 1] - out->offsets[w] > hub_limit) {
+            continue;
+        }
+        for (int j = out->offsets[w]; j < out->offsets[w + 1]; j++) {
+            int u = out->targets[j];
+            if (u != v && !placed[u] && !heap_adjust(h, u, delta)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Gorder-style greedy ordering: the next id goes to the unplaced node with
+// the most neighbors and siblings among the last 'window' placed nodes.
+int *order_gorder(graph *g, int window) {
+    assert(g != NULL && window > 0);
+    int n = g->numnodes;
+    csr_graph *out = build_csr(g);
+    csr_graph *in = build_csr_transpose(g);
+    int *perm = alloc_ids(n);
+    int *order = alloc_ids(n);
+    bool *placed = calloc(n > 0 ? n : 1, sizeof(bool));
+    unit_heap h = {0};
+    h.key = calloc(n > 0 ? n : 1, sizeof(int));
+    h.next = alloc_ids(n);
+    h.prev = alloc_ids(n);
+    h.numbuckets = 64;
+    h.head = malloc(h.numbuckets * sizeof(int));
+    bool ok = out && in && perm && order && placed && h.key && h.next && h.prev && h.head;
+
+    if (ok) {
+        for (int i = 0; i < h.numbuckets; i++) {
+            h.head[i] = -1;
+        }
+        // Insert in reverse so equal scores pop in increasing id order
+        for (int v = n - 1; v >= 0; v--) {
+            heap_link(&h, v);
+        }
+
+        int hub_limit = (int)sqrt((double)n) + 1;
+        int start = 0;
+        for (int v = 1; v < n; v++) {
+            if (in->offsets[v + 1] - in->offsets[v] > in->offsets[start + 1] - in->offsets[start]) {
+                start = v;
+            }
+        }
+
+        for (int i = 0; i < n && ok; i++) {
+            int v;
+            if (i == 0) {
+                v = start;
+                heap_unlink(&h, v);
+            } else {
+                v = heap_pop_max(&h);
+            }
+            placed[v] = true;
+            order[i] = v;
+            ok = gorder_update(&h, out, in, placed, v, 1, hub_limit);
+            if (ok && i >= window) {
+                ok = gorder_update(&h, out, in, placed, order[i - window], -1, hub_limit);
+            }
+        }
+        if (ok) {
+            order_to_perm(order, perm, n);
+        }
+    }
+
+    destroy_csr(out);
+    destroy_csr(in);
+    free(order);
+    free(placed);
+    free(h.key);
+    free(h.next);
+    free(h.prev);
+    free(h.head);
+    if (!ok) {
+        printf("Memory allocation failed\n");
+        free(perm);
+        return NULL;
+    }
+    return perm;
+}
+
+// Relabel 'g': node v of the input becomes node perm[v] of the result
+graph *permute_graph(graph *g, const int *perm) {
+    assert(g != NULL && perm != NULL);
+    graph *p = create_graph_with_allocator(g->numnodes, g->allocator);
+    if (p == NULL) {
+        return NULL;
+    }
+    for (int i = 0; i < g->numnodes; i++) {
+        for (int j = 0; j < g->numnodes; j++) {
+            if (g->edges[i][j]) {
+                p->edges[perm[i]][perm[j]] = true;
+            }
+        }
+    }
+    return p;
+}
+
+// Relabel a CSR without going through the adjacency matrix
+csr_graph *permute_csr(csr_graph *c, const int *perm) {
+    assert(c != NULL && perm != NULL);
+    int n = c->numnodes;
+    int *inverse = invert_permutation(perm, n);
+    csr_graph *p = malloc(sizeof(*p));
+    if (inverse == NULL || p == NULL) {
+        free(inverse);
+        free(p);
+        return NULL;
+    }
+    p->numnodes = n;
+    p->numedges = c->numedges;
+    p->offsets = malloc((n + 1) * sizeof(int));
+    p->targets = malloc((c->numedges > 0 ? c->numedges : 1) * sizeof(int));
+    p->weights = c->weights ? malloc((c->numedges > 0 ? c->numedges : 1) * sizeof(int)) : NULL;
+    key_pair *row = malloc((max_degree(c) + 1) * sizeof(key_pair));
+    if (p->offsets == NULL || p->targets == NULL || (c->weights && p->weights == NULL) ||
+        row == NULL) {
+        free(inverse);
+        free(row);
+        destroy_csr(p);
+        return NULL;
+    }
+
+    // Rows stay sorted by new target id, parallel arcs by weight
+    int pos = 0;
+    for (int nv = 0; nv < n; nv++) {
+        int v = inverse[nv];
+        int count = degree_of(c, v);
+        for (int i = 0; i < count; i++) {
+            int k = c->offsets[v] + i;
+            row[i] = (key_pair){ perm[c->targets[k]], c->weights ? c->weights[k] : 1 };
+        }
+        qsort(row, count, sizeof(key_pair), compare_pairs);
+        p->offsets[nv] = pos;
+        for (int i = 0; i < count; i++, pos++) {
+            p->targets[pos] = row[i].key;
+            if (p->weights) {
+                p->weights[pos] = row[i].value;
+            }
+        }
+    }
+    p->offsets[n] = pos;
+    free(inverse);
+    free(row);
+    return p;
+}
+
+// Per-node values computed on the permuted graph (distances, scores) back
+// to original ids: out[v] = values[perm[v]]
+void unpermute_values(const int *perm, const int *values, int *out, int n) {
+    for (int v = 0; v < n; v++) {
+        out[v] = values[perm[v]];
+    }
+}
+
+// Node ids listed in a result (BFS order, recommendations) back to
+// original ids, in place
+void unpermute_ids(const int *inverse, int *ids, int count) {
+    for (int i = 0; i < count; i++) {
+        if (ids[i] >= 0) {
+            ids[i] = inverse[ids[i]];
+        }
+    }
+}
+
+// Predecessor arrays are indexed by node and hold node ids, so both sides
+// are translated; -1 (no predecessor) is kept
+void unpermute_predecessors(const int *perm, const int *inverse, const int *predecessors, int *out, int n) {
+    for (int v = 0; v < n; v++) {
+        int p = predecessors[perm[v]];
+        out[v] = p >= 0 ? inverse[p] : -1;
+    }
+}
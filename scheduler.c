@@ -0,0 +1,473 @@
+#if defined(__linux__)
+#define _GNU_SOURCE     // sched_getaffinity, pthread_attr_setaffinity_np
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sched.h>
+#include <assert.h>
+#if defined(_WIN32)
+#include <windows.h>
+#include <malloc.h>
+#elif !defined(__linux__)
+#include <unistd.h>
+#endif
+#include "header.h"
+
+// Work-stealing pool shared by every parallel kernel. Each worker owns a
+// Chase-Lev deque of index ranges; it works through its range in grain-sized
+// pieces and splits off the upper half whenever its deque runs dry (lazy
+// binary splitting), so ranges are only divided when thieves take them.
+// The thread calling parallel_for is worker 0 and takes part in the loop.
+
+#define DEQUE_CAPACITY 64       // a worker only pushes onto an empty deque
+#define NO_TASK UINT64_MAX      // packed ranges never have begin == -1
+#define LOST_RACE (UINT64_MAX - 1)
+#define CACHE_LINE 64
+
+typedef struct {
+    _Alignas(CACHE_LINE) atomic_long top;       // thieves take from here
+    _Alignas(CACHE_LINE) atomic_long bottom;    // the owner pushes and takes here
+    atomic_uint_least64_t tasks[DEQUE_CAPACITY];
+} task_deque;
+
+typedef struct {
+    task_deque deque;
+    pthread_t thread;
+    unsigned long long rng;     // victim selection
+} pool_worker;
+
+static struct {
+    int numthreads;             // 0 until the pool starts
+    pool_worker *workers;
+    pthread_mutex_t submit;     // one parallel loop at a time
+    pthread_mutex_t lock;       // guards generation, stopping, users, reconfiguring
+    pthread_cond_t wake;
+    unsigned long generation;   // bumped for every loop that needs the workers
+    bool stopping;
+    pthread_cond_t idle;        // users dropped to 0 or a reconfiguration ended
+    int users;                  // kernels between scheduler_acquire and release
+    bool reconfiguring;         // scheduler_init/shutdown in progress
+
+    // The loop in flight, published before its first range is pushed
+    range_body body;
+    void *arg;
+    int grain;
+    atomic_long remaining;      // iterations not yet finished
+} pool = {
+    .submit = PTHREAD_MUTEX_INITIALIZER,
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .wake = PTHREAD_COND_INITIALIZER,
+    .idle = PTHREAD_COND_INITIALIZER,
+};
+
+// Cache-line aligned block for per-worker state, released with free_aligned
+void *alloc_aligned(size_t size) {
+    size = size > 0 ? (size + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE : CACHE_LINE;
+#if defined(_WIN32)
+    return _aligned_malloc(size, CACHE_LINE);
+#else
+    return aligned_alloc(CACHE_LINE, size);     // size must be a multiple of the alignment
+#endif
+}
+
+void free_aligned(void *p) {
+#if defined(_WIN32)
+    _aligned_free(p);
+#else
+    free(p);
+#endif
+}
+
+// Worker index of the calling thread, -1 outside the pool's loops
+static _Thread_local int current_worker = -1;
+
+static uint64_t pack_range(int begin, int end) {
+    return (uint64_t)(uint32_t)begin << 32 | (uint32_t)end;
+}
+
+// Owner side of the deque (Le, Pop, Cohen and Zappa Nardelli's C11 version)
+static void deque_push(task_deque *d, uint64_t task) {
+    long b = atomic_load_explicit(&d->bottom, memory_order_relaxed);
+    long t = atomic_load_explicit(&d->top, memory_order_acquire);
+    assert(b - t < DEQUE_CAPACITY);
+    (void)t;
+    atomic_store_explicit(&d->tasks[b % DEQUE_CAPACITY], task, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&d->bottom, b + 1, memory_order_relaxed);
+}
+
+static uint64_t deque_take(task_deque *d) {
+    long b = atomic_load_explicit(&d->bottom, memory_order_relaxed) - 1;
+    atomic_store_explicit(&d->bottom, b, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    long t = atomic_load_explicit(&d->top, memory_order_relaxed);
+    if (t > b) {
+        atomic_store_explicit(&d->bottom, b + 1, memory_order_relaxed);
+        return NO_TASK;
+    }
+    uint64_t task = atomic_load_explicit(&d->tasks[b % DEQUE_CAPACITY], memory_order_relaxed);
+    if (t == b) {
+        // Last task: race the thieves for it
+        if (!atomic_compare_exchange_strong_explicit(&d->top, &t, t + 1, memory_order_seq_cst,
+                                                     memory_order_relaxed)) {
+            task = NO_TASK;
+        }
+        atomic_store_explicit(&d->bottom, b + 1, memory_order_relaxed);
+    }
+    return task;
+}
+
+static uint64_t deque_steal(task_deque *d) {
+    long t = atomic_load_explicit(&d->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    long b = atomic_load_explicit(&d->bottom, memory_order_acquire);
+    if (t >= b) {
+        return NO_TASK;
+    }
+    uint64_t task = atomic_load_explicit(&d->tasks[t % DEQUE_CAPACITY], memory_order_relaxed);
+    if (!atomic_compare_exchange_strong_explicit(&d->top, &t, t + 1, memory_order_seq_cst,
+                                                 memory_order_relaxed)) {
+        return LOST_RACE;
+    }
+    return task;
+}
+
+static bool deque_empty(task_deque *d) {
+    return atomic_load_explicit(&d->bottom, memory_order_relaxed) <=
+           atomic_load_explicit(&d->top, memory_order_relaxed);
+}
+
+// Run [begin, end) a grain at a time, keeping the rest of the range
+// splittable while the deque is empty so idle workers can steal half
+static void run_range(int id, int begin, int end) {
+    task_deque *own = &pool.workers[id].deque;
+    int grain = pool.grain;
+    while (begin < end) {
+        while (end - begin > grain && deque_empty(own)) {
+            int mid = begin + (end - begin) / 2;
+            deque_push(own, pack_range(mid, end));
+            end = mid;
+        }
+        int stop = end - begin > grain ? begin + grain : end;
+        pool.body(begin, stop, id, pool.arg);
+        atomic_fetch_sub_explicit(&pool.remaining, stop - begin, memory_order_acq_rel);
+        begin = stop;
+    }
+}
+
+static uint64_t steal_from_others(int id) {
+    int n = pool.numthreads;
+    int start = (int)(next_random(&pool.workers[id].rng) % n);
+    for (int i = 0; i < n; i++) {
+        int victim = (start + i) % n;
+        if (victim == id) {
+            continue;
+        }
+        uint64_t task = deque_steal(&pool.workers[victim].deque);
+        if (task != NO_TASK && task != LOST_RACE) {
+            return task;
+        }
+    }
+    return NO_TASK;
+}
+
+static void work_until_done(int id) {
+    int idle = 0;
+    while (atomic_load_explicit(&pool.remaining, memory_order_acquire) > 0) {
+        uint64_t task = deque_take(&pool.workers[id].deque);
+        if (task == NO_TASK) {
+            task = steal_from_others(id);
+        }
+        if (task == NO_TASK) {
+            // Nothing to steal yet: back off instead of hammering the deques
+            if (++idle > 64) {
+                sched_yield();
+            }
+            continue;
+        }
+        idle = 0;
+        run_range(id, (int)(task >> 32), (int)(uint32_t)task);
+    }
+}
+
+static void *worker_main(void *p) {
+    int id = (int)(intptr_t)p;
+    current_worker = id;
+    unsigned long seen = 0;
+    for (;;) {
+        pthread_mutex_lock(&pool.lock);
+        while (pool.generation == seen && !pool.stopping) {
+            pthread_cond_wait(&pool.wake, &pool.lock);
+        }
+        if (pool.stopping) {
+            pthread_mutex_unlock(&pool.lock);
+            return NULL;
+        }
+        seen = pool.generation;
+        pthread_mutex_unlock(&pool.lock);
+        work_until_done(id);
+    }
+}
+
+// Join every worker thread; the caller holds pool.submit
+static void stop_pool(void) {
+    if (pool.numthreads == 0) {
+        return;
+    }
+    pthread_mutex_lock(&pool.lock);
+    pool.stopping = true;
+    pthread_cond_broadcast(&pool.wake);
+    pthread_mutex_unlock(&pool.lock);
+    for (int i = 1; i < pool.numthreads; i++) {
+        pthread_join(pool.workers[i].thread, NULL);
+    }
+    free_aligned(pool.workers);
+    pool.workers = NULL;
+    pool.numthreads = 0;
+    pool.stopping = false;
+}
+
+// Start 'numthreads' workers (0: one per CPU this process may run on),
+// worker i > 0 pinned to the i-th allowed CPU when 'pin' is set. Pinning
+// needs the Linux affinity calls and is skipped elsewhere. The caller
+// holds pool.submit.
+static bool start_pool(int numthreads, bool pin) {
+    int numcpus = 0;
+#if defined(__linux__)
+    cpu_set_t allowed;
+    int cpus[CPU_SETSIZE];
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0) {
+        for (int c = 0; c < CPU_SETSIZE; c++) {
+            if (CPU_ISSET(c, &allowed)) {
+                cpus[numcpus++] = c;
+            }
+        }
+    }
+#elif defined(_WIN32)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    numcpus = (int)info.dwNumberOfProcessors;
+    (void)pin;
+#else
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    numcpus = online > 0 ? (int)online : 0;
+    (void)pin;
+#endif
+    if (numthreads <= 0) {
+        numthreads = numcpus > 0 ? numcpus : 1;
+    }
+
+    pool.workers = alloc_aligned(numthreads * sizeof(pool_worker));
+    if (pool.workers == NULL) {
+        printf("Memory allocation failed\n");
+        return false;
+    }
+    memset(pool.workers, 0, numthreads * sizeof(pool_worker));
+    for (int i = 0; i < numthreads; i++) {
+        pool.workers[i].rng = 0x9E3779B97F4A7C15ULL * (i + 1);
+    }
+
+    pool.numthreads = 1;
+    for (int i = 1; i < numthreads; i++) {
+        pthread_attr_t attr;
+        pthread_attr_init(&attr);
+#if defined(__linux__)
+        if (pin && numcpus > 0) {
+            // Compact placement: neighboring workers share a socket/node
+            cpu_set_t one;
+            CPU_ZERO(&one);
+            CPU_SET(cpus[i % numcpus], &one);
+            pthread_attr_setaffinity_np(&attr, sizeof(one), &one);
+        }
+#endif
+        int err = pthread_create(&pool.workers[i].thread, &attr, worker_main, (void *)(intptr_t)i);
+        pthread_attr_destroy(&attr);
+        if (err != 0) {
+            printf("Failed to start scheduler threads\n");
+            stop_pool();
+            return false;
+        }
+        pool.numthreads++;
+    }
+    return true;
+}
+
+// Wait until no kernel holds the thread count, then keep new ones out
+static void begin_reconfigure(void) {
+    pthread_mutex_lock(&pool.lock);
+    while (pool.users > 0 || pool.reconfiguring) {
+        pthread_cond_wait(&pool.idle, &pool.lock);
+    }
+    pool.reconfiguring = true;
+    pthread_mutex_unlock(&pool.lock);
+}
+
+static void end_reconfigure(void) {
+    pthread_mutex_lock(&pool.lock);
+    pool.reconfiguring = false;
+    pthread_cond_broadcast(&pool.idle);
+    pthread_mutex_unlock(&pool.lock);
+}
+
+// (Re)start the pool with 'numthreads' threads in total, the caller of each
+// parallel loop included; 0 uses every CPU the process may run on. With
+// 'pin_threads' each worker is bound to one of those CPUs (Linux only;
+// other platforms ignore the flag). Without a call the pool starts on
+// first use with the defaults. Waits for kernels holding the thread count
+// (scheduler_acquire), so it must not be called from one of them or from
+// a loop body.
+bool scheduler_init(int numthreads, bool pin_threads) {
+    begin_reconfigure();
+    pthread_mutex_lock(&pool.submit);
+    stop_pool();
+    bool ok = start_pool(numthreads, pin_threads);
+    pthread_mutex_unlock(&pool.submit);
+    end_reconfigure();
+    return ok;
+}
+
+void scheduler_shutdown(void) {
+    begin_reconfigure();
+    pthread_mutex_lock(&pool.submit);
+    stop_pool();
+    pthread_mutex_unlock(&pool.submit);
+    end_reconfigure();
+}
+
+// Number of workers, i.e. the bound on the 'worker' index loop bodies see.
+// Only a snapshot outside a loop body: size per-worker scratch with
+// scheduler_acquire instead.
+int scheduler_threads(void) {
+    if (current_worker >= 0) {
+        return pool.numthreads;
+    }
+    pthread_mutex_lock(&pool.submit);
+    if (pool.numthreads == 0) {
+        start_pool(0, false);
+    }
+    int n = pool.numthreads > 0 ? pool.numthreads : 1;
+    pthread_mutex_unlock(&pool.submit);
+    return n;
+}
+
+// Thread count for sizing per-worker scratch, held fixed until the matching
+// scheduler_release: scheduler_init waits for it. Inside a loop body the
+// enclosing loop already keeps the pool fixed.
+int scheduler_acquire(void) {
+    if (current_worker >= 0) {
+        return pool.numthreads;
+    }
+    pthread_mutex_lock(&pool.lock);
+    while (pool.reconfiguring) {
+        pthread_cond_wait(&pool.idle, &pool.lock);
+    }
+    pool.users++;
+    pthread_mutex_unlock(&pool.lock);
+    return scheduler_threads();
+}
+
+void scheduler_release(void) {
+    if (current_worker >= 0) {
+        return;
+    }
+    pthread_mutex_lock(&pool.lock);
+    assert(pool.users > 0);
+    if (--pool.users == 0) {
+        pthread_cond_broadcast(&pool.idle);
+    }
+    pthread_mutex_unlock(&pool.lock);
+}
+
+// Run body over [begin, end) in pieces of at most 'grain' iterations
+// (0 picks one from the range and thread count). Loops started from inside
+// a loop body run inline on the calling worker; loops from different
+// outside threads take turns.
+void parallel_for(int begin, int end, int grain, range_body body, void *arg) {
+    assert(body != NULL);
+    if (end <= begin) {
+        return;
+    }
+    if (current_worker >= 0) {
+        body(begin, end, current_worker, arg);
+        return;
+    }
+
+    pthread_mutex_lock(&pool.submit);
+    if (pool.numthreads == 0) {
+        start_pool(0, false);
+    }
+    if (grain <= 0) {
+        long count = (long)end - begin;
+        long chunks = 16L * (pool.numthreads > 0 ? pool.numthreads : 1);
+        grain = (int)(count / chunks > 0 ? count / chunks : 1);
+    }
+
+    current_worker = 0;
+    if (pool.numthreads <= 1 || end - begin <= grain) {
+        body(begin, end, 0, arg);
+    } else {
+        pool.body = body;
+        pool.arg = arg;
+        pool.grain = grain;
+        atomic_store_explicit(&pool.remaining, (long)end - begin, memory_order_release);
+        deque_push(&pool.workers[0].deque, pack_range(begin, end));
+
+        pthread_mutex_lock(&pool.lock);
+        pool.generation++;
+        pthread_cond_broadcast(&pool.wake);
+        pthread_mutex_unlock(&pool.lock);
+        work_until_done(0);
+    }
+    current_worker = -1;
+    pthread_mutex_unlock(&pool.submit);
+}
+
+typedef struct {
+    reduce_body body;
+    void *arg;
+    unsigned char *slots;
+    size_t stride;
+} reduce_job;
+
+static void reduce_range(int begin, int end, int worker, void *p) {
+    reduce_job *job = p;
+    job->body(begin, end, worker, job->slots + worker * job->stride, job->arg);
+}
+
+// Each worker folds its pieces into a private accumulator of 'size' bytes
+// that starts as a copy of *result (the identity); the accumulators are
+// then combined into *result. Returns false on allocation failure.
+bool parallel_reduce(int begin, int end, int grain, void *result, size_t size,
+                     reduce_body body, reduce_combine combine, void *arg) {
+    assert(result != NULL && body != NULL && combine != NULL);
+    int numthreads = scheduler_acquire();
+    reduce_job job = {body, arg, NULL, (size + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE};
+    job.slots = malloc(numthreads * job.stride);
+    if (job.slots == NULL) {
+        printf("Memory allocation failed\n");
+        scheduler_release();
+        return false;
+    }
+    for (int w = 0; w < numthreads; w++) {
+        memcpy(job.slots + w * job.stride, result, size);
+    }
+    parallel_for(begin, end, grain, reduce_range, &job);
+    for (int w = 0; w < numthreads; w++) {
+        combine(result, job.slots + w * job.stride);
+    }
+    free(job.slots);
+    scheduler_release();
+    return true;
+}
+
+void reduce_sum_double(void *into, const void *from) {
+    *(double *)into += *(const double *)from;
+}
+
+void reduce_sum_long(void *into, const void *from) {
+    *(long long *)into += *(const long long *)from;
+}
@@ -0,0 +1,270 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include "header.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Galloping pays off once one list is this many times longer than the other
+#define GALLOP_RATIO 32
+
+// Append a match to 'out' when the caller wants the elements, not just a count
+#define EMIT(out, count, value) do { if (out) { (out)[count] = (value); } (count)++; } while (0)
+
+// Classic two-pointer merge of sorted, duplicate-free lists
+static int intersect_merge(const int *a, int na, const int *b, int nb, int *out) {
+    int i = 0, j = 0, count = 0;
+    while (i < na && j < nb) {
+        if (a[i] < b[j]) {
+            i++;
+        } else if (a[i] > b[j]) {
+            j++;
+        } else {
+            EMIT(out, count, a[i]);
+            i++;
+            j++;
+        }
+    }
+    return count;
+}
+
+// For each element of the short list, exponential search forward in the long
+// one. O(ns * log(nl / ns)) instead of O(ns + nl).
+static int intersect_gallop(const int *small, int ns, const int *large, int nl, int *out) {
+    int lo = 0, count = 0;
+    for (int i = 0; i < ns && lo < nl; i++) {
+        int x = small[i];
+        int step = 1, hi = lo;
+        while (hi < nl && large[hi] < x) {
+            lo = hi + 1;
+            hi += step;
+            step <<= 1;
+        }
+        if (hi > nl) {
+            hi = nl;
+        }
+        // large[lo - 1] < x <= large[hi] (when hi < nl)
+        while (lo < hi) {
+            int mid = lo + (hi - lo) / 2;
+            if (large[mid] < x) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        if (lo < nl && large[lo] == x) {
+            EMIT(out, count, x);
+            lo++;
+        }
+    }
+    return count;
+}
+
+#ifdef __SSE2__
+// Block-wise SIMD intersection: each 4-lane block of 'a' is compared against
+// all four rotations of the current block of 'b', then whichever block has
+// the smaller maximum advances. The scalar merge finishes the tails.
+static int intersect_simd(const int *a, int na, const int *b, int nb, int *out) {
+    int i = 0, j = 0, count = 0;
+    while (i + 4 <= na && j + 4 <= nb) {
+        __m128i va = _mm_loadu_si128((const __m128i *)(a + i));
+        __m128i vb = _mm_loadu_si128((const __m128i *)(b + j));
+        __m128i eq = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi32(va, vb),
+                         _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(0, 3, 2, 1)))),
+            _mm_or_si128(_mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(1, 0, 3, 2))),
+                         _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(2, 1, 0, 3)))));
+        int mask = _mm_movemask_ps(_mm_castsi128_ps(eq));
+        while (mask) {
+            int lane = __builtin_ctz(mask);
+            EMIT(out, count, a[i + lane]);
+            mask &= mask - 1;
+        }
+
+        int amax = a[i + 3], bmax = b[j + 3];
+        if (amax <= bmax) {
+            i += 4;
+        }
+        if (bmax <= amax) {
+            j += 4;
+        }
+    }
+    return count + intersect_merge(a + i, na - i, b + j, nb - j, out ? out + count : NULL);
+}
+#endif
+
+// Intersect two sorted neighbor lists, picking the kernel from their sizes.
+// Matches are written to 'out' when it is not NULL; returns the match count.
+int sorted_intersection(const int *a, int na, const int *b, int nb, int *out) {
+    if (na > nb) {
+        const int *t = a;
+        a = b;
+        b = t;
+        int tn = na;
+        na = nb;
+        nb = tn;
+    }
+    if (na == 0) {
+        return 0;
+    }
+    if (nb / na >= GALLOP_RATIO) {
+        return intersect_gallop(a, na, b, nb, out);
+    }
+#ifdef __SSE2__
+    return intersect_simd(a, na, b, nb, out);
+#else
+    return intersect_merge(a, na, b, nb, out);
+#endif
+}
+
+// Keep only edges from lower to higher (degree, id) rank. Every triangle
+// then appears exactly once, and hubs have short out-lists.
+static csr_graph *orient_by_degree(csr_graph *u) {
+    int n = u->numnodes;
+    csr_graph *o = malloc(sizeof(*o));
+    if (o == NULL) {
+        return NULL;
+    }
+    o->numnodes = n;
+    o->numedges = u->numedges / 2;
+    o->offsets = malloc((n + 1) * sizeof(int));
+    o->targets = malloc((o->numedges > 0 ? o->numedges : 1) * sizeof(int));
+    o->weights = NULL;
+    if (o->offsets == NULL || o->targets == NULL) {
+        destroy_csr(o);
+        return NULL;
+    }
+
+    int pos = 0;
+    for (int v = 0; v < n; v++) {
+        int dv = u->offsets[v + 1] - u->offsets[v];
+        o->offsets[v] = pos;
+        for (int k = u->offsets[v]; k < u->offsets[v + 1]; k++) {
+            int w = u->targets[k];
+            int dw = u->offsets[w + 1] - u->offsets[w];
+            if (dv < dw || (dv == dw && v < w)) {
+                o->targets[pos++] = w;
+            }
+        }
+    }
+    o->offsets[n] = pos;
+    return o;
+}
+
+typedef struct {
+    csr_graph *oriented;
+    long long *per_node;
+    int *common;        // 'stride' ints per worker
+    int stride;
+} triangle_job;
+
+// Triangles closed by the oriented arcs of nodes [begin, end)
+static void count_from_nodes(int begin, int end, int worker, void *accumulator, void *arg) {
+    triangle_job *job = arg;
+    csr_graph *o = job->oriented;
+    int *common = job->common + (size_t)job->stride * worker;
+    long long total = 0;
+    for (int v = begin; v < end; v++) {
+        const int *nv = o->targets + o->offsets[v];
+        int dv = o->offsets[v + 1] - o->offsets[v];
+        for (int k = 0; k < dv; k++) {
+            int w = nv[k];
+            const int *nw = o->targets + o->offsets[w];
+            int dw = o->offsets[w + 1] - o->offsets[w];
+            int found = sorted_intersection(nv, dv, nw, dw, common);
+            if (found == 0) {
+                continue;
+            }
+            total += found;
+            __atomic_fetch_add(&job->per_node[v], found, __ATOMIC_RELAXED);
+            __atomic_fetch_add(&job->per_node[w], found, __ATOMIC_RELAXED);
+            for (int i = 0; i < found; i++) {
+                __atomic_fetch_add(&job->per_node[common[i]], 1, __ATOMIC_RELAXED);
+            }
+        }
+    }
+    *(long long *)accumulator += total;
+}
+
+// Triangle statistics over an undirected CSR (symmetric, no self-loops)
+triangle_stats *count_triangles_csr(csr_graph *undirected) {
+    assert(undirected != NULL);
+    int n = undirected->numnodes;
+
+    triangle_stats *t = malloc(sizeof(*t));
+    csr_graph *o = orient_by_degree(undirected);
+    if (t == NULL || o == NULL) {
+        printf("Memory allocation failed\n");
+        free(t);
+        destroy_csr(o);
+        return NULL;
+    }
+    t->per_node = calloc(n > 0 ? n : 1, sizeof(long long));
+    t->clustering = calloc(n > 0 ? n : 1, sizeof(double));
+    if (t->per_node == NULL || t->clustering == NULL) {
+        printf("Memory allocation failed\n");
+        destroy_triangle_stats(t);
+        destroy_csr(o);
+        return NULL;
+    }
+
+    // Largest oriented out-degree bounds every intersection result
+    int maxdeg = 0;
+    for (int v = 0; v < n; v++) {
+        int d = o->offsets[v + 1] - o->offsets[v];
+        if (d > maxdeg) {
+            maxdeg = d;
+        }
+    }
+
+    // One intersection buffer per worker
+    int stride = maxdeg > 0 ? maxdeg : 1;
+    int *common = malloc((size_t)scheduler_acquire() * stride * sizeof(int));
+    long long total = 0;
+    triangle_job job = {o, t->per_node, common, stride};
+    bool ok = common != NULL && parallel_reduce(0, n, 64, &total, sizeof(long long),
+                                                count_from_nodes, reduce_sum_long, &job);
+    free(common);
+    scheduler_release();
+    destroy_csr(o);
+    if (!ok) {
+        printf("Memory allocation failed\n");
+        destroy_triangle_stats(t);
+        return NULL;
+    }
+
+    // Clustering: closed wedges over all wedges, per node and globally
+    long long wedges = 0;
+    for (int v = 0; v < n; v++) {
+        long long d = undirected->offsets[v + 1] - undirected->offsets[v];
+        long long pairs = d * (d - 1) / 2;
+        wedges += pairs;
+        t->clustering[v] = pairs > 0 ? (double)t->per_node[v] / pairs : 0.0;
+    }
+    t->triangles = total;
+    t->transitivity = wedges > 0 ? 3.0 * total / wedges : 0.0;
+    return t;
+}
+
+// Triangle statistics over the undirected view of 'g'
+triangle_stats *count_triangles(graph *g) {
+    assert(g != NULL);
+    csr_graph *undirected = build_csr_undirected(g);
+    if (undirected == NULL) {
+        printf("Memory allocation failed\n");
+        return NULL;
+    }
+    triangle_stats *t = count_triangles_csr(undirected);
+    destroy_csr(undirected);
+    return t;
+}
+
+void destroy_triangle_stats(triangle_stats *t) {
+    if (t != NULL) {
+        free(t->per_node);
+        free(t->clustering);
+        free(t);
+    }
+}